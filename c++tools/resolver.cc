@@ -72,6 +72,8 @@ module_resolver::~module_resolver ()
 {
   if (fd_repo >= 0)
     close (fd_repo);
+  while (!resident.empty ())
+    release_resident (resident.begin ()->first);
 }
 
 bool
@@ -190,6 +192,101 @@ module_resolver::read_tuple_file (int fd, char const *prefix, bool force)
   return 0;
 }
 
+/* Map the CMI FILE, lock it into memory and keep it mapped for as long
+   as we're running.  A long-lived server uses this so that the CMIs of
+   popular modules stay in memory for the benefit of every compilation
+   it serves, rather than being evicted and paged back in by each
+   importer.  If we may not lock that much memory, we fault every page
+   in instead, which keeps the pages cached but cannot stop the kernel
+   from evicting them under memory pressure.  An existing mapping is
+   reused, unless the file has been replaced since.  Failure is not an
+   error, the importer will just read the file itself.  */
+
+void
+module_resolver::make_resident (std::string const &file)
+{
+#if MAPPED_READING
+  std::string path;
+  if (!repo.empty () && file[0] != DIR_SEPARATOR)
+    {
+      path = repo;
+      path.push_back (DIR_SEPARATOR);
+    }
+  path.append (file);
+
+  struct stat statbuf;
+  if (stat (path.c_str (), &statbuf) < 0 || !S_ISREG (statbuf.st_mode))
+    {
+      release_resident (file);
+      return;
+    }
+
+  auto iter = resident.find (file);
+  if (iter != resident.end ())
+    {
+      resident_cmi const &cmi = iter->second;
+      if (cmi.dev == statbuf.st_dev && cmi.ino == statbuf.st_ino
+	  && cmi.size == size_t (statbuf.st_size)
+	  && cmi.mtime == statbuf.st_mtime)
+	return;
+      release_resident (file);
+    }
+
+  if (!statbuf.st_size)
+    return;
+
+  int fd = open (path.c_str (), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return;
+  void *mapping = mmap (nullptr, statbuf.st_size, PROT_READ, MAP_SHARED,
+			fd, 0);
+  close (fd);
+  if (mapping == MAP_FAILED)
+    return;
+  /* Ask for the whole thing to be read in now.  Importers will touch
+     it randomly, which defeats readahead.  */
+  madvise (reinterpret_cast <char *> (mapping), statbuf.st_size,
+	   MADV_WILLNEED);
+#if defined (_POSIX_MEMLOCK_RANGE) && _POSIX_MEMLOCK_RANGE > 0
+  if (mlock (mapping, statbuf.st_size) < 0)
+#endif
+    {
+      /* MADV_WILLNEED only starts the reads, wait for them.  */
+      long page_size = sysconf (_SC_PAGESIZE);
+      if (page_size <= 0)
+	page_size = 4096;
+      volatile char const *bytes = reinterpret_cast <char *> (mapping);
+      for (off_t off = 0; off < statbuf.st_size; off += page_size)
+	(void)bytes[off];
+    }
+
+  resident_cmi &cmi = resident[file];
+  cmi.mapping = mapping;
+  cmi.size = statbuf.st_size;
+  cmi.dev = statbuf.st_dev;
+  cmi.ino = statbuf.st_ino;
+  cmi.mtime = statbuf.st_mtime;
+#else
+  (void)file;
+#endif
+}
+
+/* Drop any mapping of CMI FILE.  */
+
+void
+module_resolver::release_resident (std::string const &file)
+{
+  auto iter = resident.find (file);
+  if (iter == resident.end ())
+    return;
+
+#if MAPPED_READING
+  munmap (reinterpret_cast <char *> (iter->second.mapping),
+	  iter->second.size);
+#endif
+  resident.erase (iter);
+}
+
 char const *
 module_resolver::GetCMISuffix ()
 {
@@ -236,7 +333,11 @@ module_resolver::cmi_response (Cody::Server *s, std::string &module)
   if (iter->second.empty ())
     s->ErrorResponse ("no such module");
   else
-    s->PathnameResponse (iter->second);
+    {
+      if (keep_resident)
+	make_resident (iter->second);
+      s->PathnameResponse (iter->second);
+    }
 
   return 0;
 }
@@ -255,48 +356,130 @@ module_resolver::ModuleImportRequest (Cody::Server *s, Cody::Flags,
   return cmi_response (s, module);
 }
 
+/* Stat FILE, which is relative to the repository.  Return true on
+   success.  */
+
+bool
+module_resolver::repo_stat (std::string const &file, struct stat &statbuf)
+{
+#if HAVE_FSTATAT
+  int fd_dir = AT_FDCWD;
+  if (!repo.empty ())
+    {
+      if (fd_repo == -1)
+	{
+	  fd_repo = open (repo.c_str (),
+			  O_RDONLY | O_CLOEXEC | O_DIRECTORY);
+	  if (fd_repo < 0)
+	    fd_repo = -2;
+	}
+      fd_dir = fd_repo;
+    }
+
+  if (!repo.empty () && fd_repo < 0)
+    return false;
+  return fstatat (fd_dir, file.c_str (), &statbuf, 0) == 0;
+#else
+  auto append = repo;
+  append.push_back (DIR_SEPARATOR);
+  append.append (file);
+  return stat (append.c_str (), &statbuf) == 0;
+#endif
+}
+
+/* Return the directory containing CMI FILE.  */
+
+static std::string
+cmi_directory (std::string const &file)
+{
+  auto slash = file.find_last_of (DIR_SEPARATOR);
+  if (slash == file.npos)
+    return ".";
+  return file.substr (0, slash ? slash : 1);
+}
+
+/* Return the nanoseconds of the modification time in ST, or -1 if the
+   host's struct stat only has whole seconds.  */
+
+static long
+stat_mtime_nsec (struct stat const &st)
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+  return st.st_mtim.tv_nsec;
+#else
+  (void)st;
+  return -1;
+#endif
+}
+
+/* Return the stamp of a directory with status STATBUF.  With only whole
+   seconds, a directory changed in the current second may change again
+   without its stamp changing, so such a stamp is racy.  */
+
+static module_resolver::dir_stamp
+make_dir_stamp (struct stat const &statbuf)
+{
+  module_resolver::dir_stamp stamp;
+
+  stamp.sec = statbuf.st_mtime;
+  stamp.nsec = stat_mtime_nsec (statbuf);
+  stamp.racy = stamp.nsec < 0 && stamp.sec >= time (nullptr);
+  return stamp;
+}
+
+/* We failed to find CMI FILE when its directory had modification time
+   STAMP.  Return true if that directory has changed since, and so the
+   CMI might have appeared.  This lets a long-lived resolver cache
+   failed include translation probes, yet still notice header units
+   that are built behind its back.  */
+
+bool
+module_resolver::probe_miss_stale (std::string const &file,
+				   dir_stamp const &stamp)
+{
+  struct stat statbuf;
+
+  if (!repo_stat (cmi_directory (file), statbuf))
+    return stamp.sec != 0;
+  if (stamp.racy)
+    return true;
+  return (statbuf.st_mtime != stamp.sec
+	  || stat_mtime_nsec (statbuf) != stamp.nsec);
+}
+
 int
 module_resolver::IncludeTranslateRequest (Cody::Server *s, Cody::Flags,
 					  std::string &include)
 {
   auto iter = map.find (include);
+  if (iter != map.end () && default_translate)
+    {
+      // Check a cached miss is still a miss
+      auto miss = probe_misses.find (include);
+      if (miss != probe_misses.end ()
+	  && probe_miss_stale (GetCMIName (include), miss->second))
+	{
+	  probe_misses.erase (miss);
+	  map.erase (iter);
+	  iter = map.end ();
+	}
+    }
+
   if (iter == map.end () && default_translate)
     {
       // Not found, look for it
       auto file = GetCMIName (include);
       struct stat statbuf;
-      bool ok = true;
 
-#if HAVE_FSTATAT
-      int fd_dir = AT_FDCWD;
-      if (!repo.empty ())
+      if (!repo_stat (file, statbuf) || !S_ISREG (statbuf.st_mode))
 	{
-	  if (fd_repo == -1)
-	    {
-	      fd_repo = open (repo.c_str (),
-			      O_RDONLY | O_CLOEXEC | O_DIRECTORY);
-	      if (fd_repo < 0)
-		fd_repo = -2;
-	    }
-	  fd_dir = fd_repo;
+	  // Mark as not present, remembering when we looked
+	  dir_stamp stamp;
+	  if (repo_stat (cmi_directory (file), statbuf))
+	    stamp = make_dir_stamp (statbuf);
+	  probe_misses[include] = stamp;
+	  file.clear ();
 	}
-
-      if (!repo.empty () && fd_repo < 0)
-	ok = false;
-      else if (fstatat (fd_dir, file.c_str (), &statbuf, 0) < 0
-	       || !S_ISREG (statbuf.st_mode))
-	ok = false;
-#else
-      auto append = repo;
-      append.push_back (DIR_SEPARATOR);
-      append.append (file);
-      if (stat (append.c_str (), &statbuf) < 0
-	  || !S_ISREG (statbuf.st_mode))
-	ok = false;
-#endif
-      if (!ok)
-	// Mark as not present
-	file.clear ();
       auto res = map.emplace (include, file);
       iter = res.first;
     }
@@ -304,19 +487,32 @@ module_resolver::IncludeTranslateRequest (Cody::Server *s, Cody::Flags,
   if (iter == map.end () || iter->second.empty ())
     s->BoolResponse (false);
   else
-    s->PathnameResponse (iter->second);
+    {
+      if (keep_resident)
+	make_resident (iter->second);
+      s->PathnameResponse (iter->second);
+    }
 
   return 0;
 }
 
 /* This handles a client notification to the server that a CMI has been
-   produced for a module.  For this simplified server, we just accept
-   the transaction and respond with "OK".  */
+   produced for a module.  For this simplified server, we just drop any
+   resident mapping of the previous CMI, forget we failed to find it if
+   it is a header unit, accept the transaction and respond with "OK".  */
 
 int
 module_resolver::ModuleCompiledRequest (Cody::Server *s, Cody::Flags,
-				      std::string &)
+				      std::string &module)
 {
+  auto iter = map.find (module);
+  if (iter != map.end ())
+    {
+      if (!iter->second.empty ())
+	release_resident (iter->second);
+      else if (probe_misses.erase (module))
+	map.erase (iter);
+    }
   s->OKResponse();
   return 0;
 }
@@ -27,6 +27,9 @@ along with GCC; see the file COPYING3.  If not see
 #if !IN_GCC
 #include <string>
 #include <map>
+// OS
+#include <sys/types.h>
+#include <sys/stat.h>
 #endif
 
 // This is a GCC class, so GCC coding conventions on new bits.  
@@ -36,13 +39,36 @@ public:
   using parent = Cody::Resolver;
   using module_map = std::map<std::string, std::string>;
 
+  // A CMI we keep mapped, and the identity of the file we mapped.
+  struct resident_cmi
+  {
+    void *mapping = nullptr;
+    size_t size = 0;
+    dev_t dev = 0;
+    ino_t ino = 0;
+    time_t mtime = 0;
+  };
+  using resident_map = std::map<std::string, resident_cmi>;
+  // The modification time of a directory we probed.
+  struct dir_stamp
+  {
+    time_t sec = 0;
+    long nsec = 0;
+    // Changes in the same second cannot be told apart.
+    bool racy = false;
+  };
+  using stamp_map = std::map<std::string, dir_stamp>;
+
 private:
   std::string repo;
   std::string ident;
   module_map map;
+  resident_map resident;
+  stamp_map probe_misses;
   int fd_repo = -1;
   bool default_map = true;
   bool default_translate = true;
+  bool keep_resident = false;
 
 public:
   module_resolver (bool map = true, bool xlate = false);
@@ -61,6 +87,10 @@ public:
   {
     ident = i;
   }
+  void set_keep_resident (bool r)
+  {
+    keep_resident = r;
+  }
   bool set_repo (std::string &&repo, bool force = false);
   bool add_mapping (std::string &&module, std::string &&file,
 		    bool force = false);
@@ -106,6 +136,10 @@ private:
 
 private:
   int cmi_response (Cody::Server *s, std::string &module);
+  bool repo_stat (std::string const &file, struct stat &statbuf);
+  bool probe_miss_stale (std::string const &file, dir_stamp const &stamp);
+  void make_resident (std::string const &file);
+  void release_resident (std::string const &file);
 };
 
 #endif
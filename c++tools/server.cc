@@ -188,6 +188,9 @@ static bool flag_xlate = false;
 /* Root binary directory.  */
 static const char *flag_root = "gcm.cache";
 
+/* Keep served CMIs mapped.  */
+static bool flag_resident = false;
+
 #if NETWORKING
 static netmask_set_t netmask_set;
 
@@ -305,6 +308,7 @@ print_usage (int error_p)
   fnotice (file, "  -n, --noisy      Print progress messages\n");
   fnotice (file, "  -1, --one        One connection and then exit\n");
   fnotice (file, "  -r, --root DIR   Root compiled module directory\n");
+  fnotice (file, "  -R, --resident   Keep served CMIs resident in memory\n");
   fnotice (file, "  -s, --sequential Process connections sequentially\n");
   fnotice (file, "  -v, --version    Print version number, then exit\n");
   fnotice (file, "Send SIGTERM(%d) to terminate\n", SIGTERM);
@@ -394,6 +398,7 @@ process_args (int argc, char **argv)
      { "noisy",	no_argument,	NULL, 'n' },
      { "one",	no_argument,	NULL, '1' },
      { "root",	required_argument, NULL, 'r' },
+     { "resident", no_argument,	NULL, 'R' },
      { "sequential", no_argument, NULL, 's' },
      { "translate",no_argument,	NULL, 't' },
      { "version", no_argument,	NULL, 'v' },
@@ -401,7 +406,7 @@ process_args (int argc, char **argv)
     };
   int opt;
   bool bad_accept = false;
-  const char *opts = "a:fhmn1r:stv";
+  const char *opts = "a:fhmn1r:Rstv";
   while ((opt = getopt_long (argc, argv, opts, options, NULL)) != -1)
     {
       switch (opt)
@@ -426,6 +431,9 @@ process_args (int argc, char **argv)
 	case 'r':
 	  flag_root = optarg;
 	  break;
+	case 'R':
+	  flag_resident = true;
+	  break;
 	case 's':
 	  flag_sequential = true;
 	  break;
@@ -915,6 +923,7 @@ main (int argc, char *argv[])
   std::string name;
   int sock_fd = -1; /* Socket fd, otherwise stdin/stdout.  */
   module_resolver r (flag_map, flag_xlate);
+  r.set_keep_resident (flag_resident);
 
   if (argno != argc)
     {
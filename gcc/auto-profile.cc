@@ -46,6 +46,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "ipa-fnsummary.h"
 #include "ipa-inline.h"
 #include "tree-inline.h"
+#include "selftest.h"
 #include "auto-profile.h"
 #include "tree-pretty-print.h"
 #include "gimple-pretty-print.h"
@@ -71,6 +72,10 @@ along with GCC; see the file COPYING3.  If not see
      A function instance is an instance of function that could either be a
      standalone symbol, or a clone of a function that is inlined into another
      function.
+     The profile data file is produced by create_gcov, or by "gcov-tool
+     autofdo" from a text sample profile, which is where the calling
+     contexts of context-sensitive profiles become nested function_instances
+     of the callers.
 
    Phase 2: Early inline + value profile transformation.
      Early inline uses autofdo_source_profile to find if a callsite is:
@@ -95,7 +100,6 @@ along with GCC; see the file COPYING3.  If not see
 */
 
 #define DEFAULT_AUTO_PROFILE_FILE "fbdata.afdo"
-#define AUTO_PROFILE_VERSION 2
 
 namespace autofdo
 {
@@ -146,9 +150,7 @@ public:
 
   /* Whether this inline stack is already used in annotation.
 
-     Each inline stack should only be used to annotate IR once.
-     This will be enforced when instruction-level discriminator
-     is supported.  */
+     Each inline stack should only be used to annotate IR once.  */
   bool annotated;
 };
 
@@ -247,6 +249,16 @@ public:
   void mark_annotated (location_t loc);
 
 private:
+#if CHECKING_P
+  friend void ::selftest::auto_profile_cc_tests ();
+#endif
+
+  /* Map from source location (decl_lineno) to profile (count_info).  */
+  typedef std::map<unsigned, count_info> position_count_map;
+
+  /* Return the entry of pos_counts to use for LOC.  */
+  position_count_map::const_iterator find_pos_count (unsigned loc) const;
+
   /* Callsite, represented as (decl_lineno, callee_function_name_index).  */
   typedef std::pair<unsigned, unsigned> callsite;
 
@@ -258,9 +270,6 @@ private:
   {
   }
 
-  /* Map from source location (decl_lineno) to profile (count_info).  */
-  typedef std::map<unsigned, count_info> position_count_map;
-
   /* function_instance name index in the string_table.  */
   unsigned name_;
 
@@ -308,8 +317,9 @@ public:
      Return true if INFO is updated.  */
   bool update_inlined_ind_target (gcall *stmt, count_info *info);
 
-  /* Mark LOC as annotated.  */
-  void mark_annotated (location_t loc);
+  /* Mark LOC of a statement in a basic block with DISCRIMINATOR as
+     annotated.  */
+  void mark_annotated (location_t loc, int discriminator);
 
 private:
   /* Map from function_instance name index (in string_table) to
@@ -377,10 +387,13 @@ get_function_decl_from_block (tree block)
   return BLOCK_ABSTRACT_ORIGIN (block);
 }
 
-/* Store inline stack for STMT in STACK.  */
+/* Store inline stack for LOCUS in STACK.  DISCRIMINATOR is the
+   discriminator of the basic block LOCUS belongs to and is combined with
+   the location of the leaf.  */
 
 static void
-get_inline_stack (location_t locus, inline_stack *stack)
+get_inline_stack (location_t locus, inline_stack *stack,
+		  int discriminator = 0)
 {
   if (LOCATION_LOCUS (locus) == UNKNOWN_LOCATION)
     return;
@@ -398,15 +411,18 @@ get_inline_stack (location_t locus, inline_stack *stack)
             continue;
 
           tree decl = get_function_decl_from_block (block);
-          stack->safe_push (
-              std::make_pair (decl, get_combined_location (locus, decl)));
+          unsigned offset = get_combined_location (locus, decl);
+          if (level == 0)
+            offset |= discriminator & 0xffff;
+          stack->safe_push (std::make_pair (decl, offset));
           locus = tmp_locus;
           level++;
         }
     }
-  stack->safe_push (
-      std::make_pair (current_function_decl,
-                      get_combined_location (locus, current_function_decl)));
+  unsigned offset = get_combined_location (locus, current_function_decl);
+  if (stack->is_empty ())
+    offset |= discriminator & 0xffff;
+  stack->safe_push (std::make_pair (current_function_decl, offset));
 }
 
 /* Return STMT's combined location, which is a 32bit integer in which
@@ -560,13 +576,37 @@ function_instance::get_function_instance_by_decl (unsigned lineno,
   return NULL;
 }
 
+/* Return the entry of pos_counts to use for LOC, or pos_counts.end () if
+   there is none.  Only the exact line and discriminator match when the
+   profile has discriminators for the line: a missing discriminator means
+   its blocks were never sampled.  Profiles collected without
+   discriminators only have the entry of the line, which is then used for
+   all the statements of the line.  */
+
+function_instance::position_count_map::const_iterator
+function_instance::find_pos_count (unsigned loc) const
+{
+  position_count_map::const_iterator iter = pos_counts.find (loc);
+  if (iter != pos_counts.end ())
+    return iter;
+
+  unsigned line = loc & 0xffff0000;
+  if (loc == line)
+    return pos_counts.end ();
+
+  iter = pos_counts.upper_bound (line);
+  if (iter != pos_counts.end () && (iter->first & 0xffff0000) == line)
+    return pos_counts.end ();
+  return pos_counts.find (line);
+}
+
 /* Store the profile info for LOC in INFO. Return TRUE if profile info
    is found.  */
 
 bool
 function_instance::get_count_info (location_t loc, count_info *info) const
 {
-  position_count_map::const_iterator iter = pos_counts.find (loc);
+  position_count_map::const_iterator iter = find_pos_count (loc);
   if (iter == pos_counts.end ())
     return false;
   *info = iter->second;
@@ -578,10 +618,10 @@ function_instance::get_count_info (location_t loc, count_info *info) const
 void
 function_instance::mark_annotated (location_t loc)
 {
-  position_count_map::iterator iter = pos_counts.find (loc);
+  position_count_map::const_iterator iter = find_pos_count (loc);
   if (iter == pos_counts.end ())
     return;
-  iter->second.annotated = true;
+  pos_counts[iter->first].annotated = true;
 }
 
 /* Read the inlined indirect call target profile for STMT and store it in
@@ -654,7 +694,9 @@ function_instance::read_function_instance (function_instance_stack *stack,
 
   for (unsigned i = 0; i < num_pos_counts; i++)
     {
-      unsigned offset = gcov_read_unsigned () & 0xffff0000;
+      /* The upper 16 bits are the line offset, the lower 16 bits the
+         discriminator.  */
+      unsigned offset = gcov_read_unsigned ();
       unsigned num_targets = gcov_read_unsigned ();
       gcov_type count = gcov_read_counter ();
       s->pos_counts[offset].count = count;
@@ -727,7 +769,8 @@ autofdo_source_profile::get_count_info (gimple *stmt, count_info *info) const
     return false;
 
   inline_stack stack;
-  get_inline_stack (gimple_location (stmt), &stack);
+  get_inline_stack (gimple_location (stmt), &stack,
+		    gimple_bb (stmt) ? gimple_bb (stmt)->discriminator : 0);
   if (stack.length () == 0)
     return false;
   function_instance *s = get_function_instance_by_inline_stack (stack);
@@ -736,13 +779,14 @@ autofdo_source_profile::get_count_info (gimple *stmt, count_info *info) const
   return s->get_count_info (stack[0].second, info);
 }
 
-/* Mark LOC as annotated.  */
+/* Mark LOC of a statement in a basic block with DISCRIMINATOR as
+   annotated.  */
 
 void
-autofdo_source_profile::mark_annotated (location_t loc)
+autofdo_source_profile::mark_annotated (location_t loc, int discriminator)
 {
   inline_stack stack;
-  get_inline_stack (loc, &stack);
+  get_inline_stack (loc, &stack, discriminator);
   if (stack.length () == 0)
     return;
   function_instance *s = get_function_instance_by_inline_stack (stack);
@@ -1132,7 +1176,8 @@ afdo_set_bb_count (basic_block bb, const stmt_set &promoted)
     return false;
 
   for (gsi = gsi_start_bb (bb); !gsi_end_p (gsi); gsi_next (&gsi))
-    afdo_source_profile->mark_annotated (gimple_location (gsi_stmt (gsi)));
+    afdo_source_profile->mark_annotated (gimple_location (gsi_stmt (gsi)),
+                                         bb->discriminator);
   for (gphi_iterator gpi = gsi_start_phis (bb);
        !gsi_end_p (gpi);
        gsi_next (&gpi))
@@ -1140,10 +1185,11 @@ afdo_set_bb_count (basic_block bb, const stmt_set &promoted)
       gphi *phi = gpi.phi ();
       size_t i;
       for (i = 0; i < gimple_phi_num_args (phi); i++)
-        afdo_source_profile->mark_annotated (gimple_phi_arg_location (phi, i));
+        afdo_source_profile->mark_annotated (gimple_phi_arg_location (phi, i),
+                                             0);
     }
   FOR_EACH_EDGE (e, ei, bb->succs)
-  afdo_source_profile->mark_annotated (e->goto_locus);
+  afdo_source_profile->mark_annotated (e->goto_locus, 0);
 
   bb->count = profile_count::from_gcov_type (max_count).afdo ();
   return true;
@@ -1569,9 +1615,9 @@ afdo_annotate_cfg (const stmt_set &promoted_stmts)
       set_bb_annotated (EXIT_BLOCK_PTR_FOR_FN (cfun)->prev_bb, &annotated_bb);
     }
   afdo_source_profile->mark_annotated (
-      DECL_SOURCE_LOCATION (current_function_decl));
-  afdo_source_profile->mark_annotated (cfun->function_start_locus);
-  afdo_source_profile->mark_annotated (cfun->function_end_locus);
+      DECL_SOURCE_LOCATION (current_function_decl), 0);
+  afdo_source_profile->mark_annotated (cfun->function_start_locus, 0);
+  afdo_source_profile->mark_annotated (cfun->function_end_locus, 0);
   if (max_count > profile_count::zero ())
     {
       /* Calculate, propagate count and probability information on CFG.  */
@@ -1771,3 +1817,59 @@ make_pass_ipa_auto_profile (gcc::context *ctxt)
 {
   return new pass_ipa_auto_profile (ctxt);
 }
+
+#if CHECKING_P
+
+namespace selftest {
+
+/* Run all of the selftests within this file.  */
+
+void
+auto_profile_cc_tests ()
+{
+  /* Verify the lookup of position counts by discriminator.  */
+  autofdo::function_instance *fi = new autofdo::function_instance (0, 0);
+  auto add = [fi] (unsigned line, unsigned discriminator, gcov_type count)
+    {
+      autofdo::count_info &info
+	= fi->pos_counts[(line << 16) | discriminator];
+      info.count = count;
+      info.annotated = false;
+    };
+  auto find = [fi] (unsigned line, unsigned discriminator) -> gcov_type
+    {
+      auto iter = fi->find_pos_count ((line << 16) | discriminator);
+      return iter == fi->pos_counts.end () ? -1 : iter->second.count;
+    };
+
+  /* Line 3 has samples for two discriminators.  */
+  add (3, 1, 100);
+  add (3, 2, 5);
+  /* Line 4 has samples without and with discriminator.  */
+  add (4, 0, 9);
+  add (4, 1, 3);
+  /* Line 5 comes from a profile without discriminators.  */
+  add (5, 0, 7);
+
+  ASSERT_EQ (find (3, 1), 100);
+  ASSERT_EQ (find (3, 2), 5);
+  /* Blocks of a line that were never sampled do not get the counts of
+     other discriminators.  */
+  ASSERT_EQ (find (3, 3), -1);
+  ASSERT_EQ (find (3, 0), -1);
+  ASSERT_EQ (find (4, 0), 9);
+  ASSERT_EQ (find (4, 1), 3);
+  ASSERT_EQ (find (4, 2), -1);
+  /* Without discriminators in the profile all blocks of the line share
+     its counts.  */
+  ASSERT_EQ (find (5, 0), 7);
+  ASSERT_EQ (find (5, 2), 7);
+  ASSERT_EQ (find (6, 0), -1);
+  ASSERT_EQ (find (6, 1), -1);
+
+  delete fi;
+}
+
+} // namespace selftest
+
+#endif /* CHECKING_P */
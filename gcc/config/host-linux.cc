@@ -168,19 +168,22 @@ linux_gt_pch_get_address (size_t size, int fd)
 }
 
 /* Map SIZE bytes of FD+OFFSET at BASE.  Return 1 if we succeeded at
-   mapping the data at BASE, -1 if we couldn't.
+   mapping the data, updating BASE if it is not where we asked for it,
+   -1 if we couldn't.
 
    It's not possibly to reliably mmap a file using MAP_PRIVATE to
    a specific START address on either hpux or linux.  First we see
    if mmap with MAP_PRIVATE works.  If it does, we are off to the
-   races.  If it doesn't, we try an anonymous private mmap since the
-   kernel is more likely to honor the BASE address in anonymous maps.
-   We then copy the data to the anonymous private map.  This assumes
-   of course that we don't need to change the data in the PCH file
-   after it is created.
+   races.  If the kernel placed the mapping somewhere else, we keep it
+   there anyway: gt_pch_restore relocates the image, and only the pages
+   that contain pointers get copied, the rest are read lazily from the
+   file when first touched.  Only if the file can't be mapped at all do
+   we try an anonymous private mmap and copy the data into it.  This
+   assumes of course that we don't need to change the data in the PCH
+   file after it is created.
 
-   This approach obviously causes a performance penalty but there is
-   little else we can do given the current PCH implementation.  */
+   The anonymous fallback obviously causes a performance penalty, as
+   the whole image is read in up front.  */
 
 static int
 linux_gt_pch_use_address (void *&base, size_t size, int fd, size_t offset)
@@ -196,11 +199,11 @@ linux_gt_pch_use_address (void *&base, size_t size, int fd, size_t offset)
   /* Try to map the file with MAP_PRIVATE.  */
   addr = mmap (base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, offset);
 
-  if (addr == base)
-    return 1;
-
   if (addr != (void *) MAP_FAILED)
-    munmap (addr, size);
+    {
+      base = addr;
+      return 1;
+    }
 
   /* Try to make an anonymous private mmap at the desired location.  */
   addr = mmap (base, size, PROT_READ | PROT_WRITE,
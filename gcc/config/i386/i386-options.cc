@@ -781,6 +781,8 @@ ix86_option_override_internal (bool main_args_p,
 static void
 set_ix86_tune_features (struct gcc_options *opts,
 			enum processor_type ix86_tune, bool dump);
+static const struct processor_costs *
+ix86_tune_costs (struct gcc_options *opts, enum processor_type tune);
 
 /* Restore the current options */
 
@@ -824,7 +826,7 @@ ix86_function_specific_restore (struct gcc_options *opts,
   opts->x_ix86_tune_memcpy_strategy = ptr->x_ix86_tune_memcpy_strategy;
   opts->x_ix86_tune_memset_strategy = ptr->x_ix86_tune_memset_strategy;
   opts->x_ix86_tune_no_default = ptr->x_ix86_tune_no_default;
-  ix86_tune_cost = processor_cost_table[ix86_tune];
+  ix86_tune_cost = ix86_tune_costs (opts, ix86_tune);
   /* TODO: ix86_cost should be chosen at instruction or function granuality
      so for cold code we use size_cost even in !optimize_size compilation.  */
   if (opts->x_optimize_size)
@@ -1747,6 +1749,172 @@ set_ix86_tune_features (struct gcc_options *opts,
 }
 
 
+/* The costs -mtune-costs=FILE can set, each given by as many integers as
+   the field has elements.  */
+
+#define IX86_COST_FIELD(NAME) \
+  { #NAME, offsetof (struct processor_costs, NAME), \
+    sizeof (((struct processor_costs *) 0)->NAME) / sizeof (int) }
+
+static const struct
+{
+  const char *name;
+  size_t offset;
+  unsigned count;
+} ix86_cost_fields[] =
+{
+  IX86_COST_FIELD (add),
+  IX86_COST_FIELD (lea),
+  IX86_COST_FIELD (shift_var),
+  IX86_COST_FIELD (shift_const),
+  IX86_COST_FIELD (mult_init),
+  IX86_COST_FIELD (mult_bit),
+  IX86_COST_FIELD (divide),
+  IX86_COST_FIELD (movsx),
+  IX86_COST_FIELD (movzx),
+  IX86_COST_FIELD (int_load),
+  IX86_COST_FIELD (int_store),
+  IX86_COST_FIELD (sse_load),
+  IX86_COST_FIELD (sse_store),
+  IX86_COST_FIELD (sse_unaligned_load),
+  IX86_COST_FIELD (sse_unaligned_store),
+  IX86_COST_FIELD (xmm_move),
+  IX86_COST_FIELD (ymm_move),
+  IX86_COST_FIELD (zmm_move),
+  IX86_COST_FIELD (sse_to_integer),
+  IX86_COST_FIELD (gather_static),
+  IX86_COST_FIELD (gather_per_elt),
+  IX86_COST_FIELD (scatter_static),
+  IX86_COST_FIELD (scatter_per_elt),
+  IX86_COST_FIELD (fadd),
+  IX86_COST_FIELD (fmul),
+  IX86_COST_FIELD (fdiv),
+  IX86_COST_FIELD (fabs),
+  IX86_COST_FIELD (fchs),
+  IX86_COST_FIELD (fsqrt),
+  IX86_COST_FIELD (sse_op),
+  IX86_COST_FIELD (addss),
+  IX86_COST_FIELD (mulss),
+  IX86_COST_FIELD (mulsd),
+  IX86_COST_FIELD (fmass),
+  IX86_COST_FIELD (fmasd),
+  IX86_COST_FIELD (divss),
+  IX86_COST_FIELD (divsd),
+  IX86_COST_FIELD (sqrtss),
+  IX86_COST_FIELD (sqrtsd),
+  IX86_COST_FIELD (cond_taken_branch_cost),
+  IX86_COST_FIELD (cond_not_taken_branch_cost)
+};
+
+#undef IX86_COST_FIELD
+
+/* The costs read from the -mtune-costs= file: for each line of the file
+   the index of the cost in ix86_cost_fields followed by its values.  */
+static vec<int> ix86_file_costs;
+static bool ix86_file_costs_read;
+
+/* The costs of the processors overridden by the -mtune-costs= file.  */
+static struct processor_costs *ix86_file_cost_table[PROCESSOR_max];
+
+/* Read the -mtune-costs= file FILENAME into ix86_file_costs.  Each line
+   names a cost followed by its values, in the units of the tables in
+   x86-tune-costs.h.  '#' starts a comment.  */
+
+static void
+ix86_read_tune_costs (const char *filename)
+{
+  FILE *f = fopen (filename, "r");
+  if (!f)
+    {
+      error ("cannot open %<-mtune-costs%> file %qs: %m", filename);
+      return;
+    }
+
+  char line[1024];
+  int lineno = 0;
+  while (fgets (line, sizeof (line), f))
+    {
+      lineno++;
+      char *p = strchr (line, '#');
+      if (p)
+	*p = '\0';
+      char *name = strtok (line, " \t\r\n");
+      if (!name)
+	continue;
+
+      unsigned i;
+      for (i = 0; i < ARRAY_SIZE (ix86_cost_fields); i++)
+	if (!strcmp (name, ix86_cost_fields[i].name))
+	  break;
+      if (i == ARRAY_SIZE (ix86_cost_fields))
+	{
+	  error ("%s:%d: unknown cost %qs", filename, lineno, name);
+	  continue;
+	}
+
+      unsigned start = ix86_file_costs.length ();
+      bool valid = true;
+      ix86_file_costs.safe_push (i);
+      while (char *value = strtok (NULL, " \t\r\n"))
+	{
+	  char *end;
+	  long cost = strtol (value, &end, 10);
+	  if (*end || cost < 0 || cost > INT_MAX)
+	    {
+	      error ("%s:%d: invalid value %qs of cost %qs", filename, lineno,
+		     value, name);
+	      valid = false;
+	      break;
+	    }
+	  ix86_file_costs.safe_push (cost);
+	}
+      if (valid
+	  && ix86_file_costs.length () - start - 1 != ix86_cost_fields[i].count)
+	{
+	  error ("%s:%d: cost %qs needs %u values", filename, lineno, name,
+		 ix86_cost_fields[i].count);
+	  valid = false;
+	}
+      if (!valid)
+	ix86_file_costs.truncate (start);
+    }
+  fclose (f);
+}
+
+/* Return the costs of processor TUNE, overridden by the ones given by
+   -mtune-costs= if any.  */
+
+static const struct processor_costs *
+ix86_tune_costs (struct gcc_options *opts, enum processor_type tune)
+{
+  if (!opts->x_ix86_tune_costs_file)
+    return processor_cost_table[tune];
+
+  if (!ix86_file_costs_read)
+    {
+      ix86_read_tune_costs (opts->x_ix86_tune_costs_file);
+      ix86_file_costs_read = true;
+    }
+  if (!ix86_file_cost_table[tune])
+    {
+      /* The cost tables themselves are const, but the fields of the
+	 copy are not.  */
+      struct processor_costs *costs
+	= new processor_costs (*processor_cost_table[tune]);
+      for (unsigned i = 0; i < ix86_file_costs.length ();
+	   i += ix86_cost_fields[ix86_file_costs[i]].count + 1)
+	{
+	  int *field = (int *) ((char *) costs
+				+ ix86_cost_fields[ix86_file_costs[i]].offset);
+	  for (unsigned j = 0; j < ix86_cost_fields[ix86_file_costs[i]].count;
+	       j++)
+	    field[j] = ix86_file_costs[i + 1 + j];
+	}
+      ix86_file_cost_table[tune] = costs;
+    }
+  return ix86_file_cost_table[tune];
+}
+
 /* Default align_* from the processor table.  */
 
 static void
@@ -2331,7 +2499,7 @@ ix86_option_override_internal (bool main_args_p,
 
   ix86_recompute_optlev_based_flags (opts, opts_set);
 
-  ix86_tune_cost = processor_cost_table[ix86_tune];
+  ix86_tune_cost = ix86_tune_costs (opts, ix86_tune);
   /* TODO: ix86_cost should be chosen at instruction or function granuality
      so for cold code we use size_cost even in !optimize_size compilation.  */
   if (opts->x_optimize_size)
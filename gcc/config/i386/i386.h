@@ -107,99 +107,99 @@ struct processor_costs {
      cost is 2.  */
   struct
     {
-      const int movzbl_load;	/* cost of loading using movzbl */
-      const int int_load[3];	/* cost of loading integer registers
+      int movzbl_load;		/* cost of loading using movzbl */
+      int int_load[3];		/* cost of loading integer registers
 				   in QImode, HImode and SImode relative
 				   to reg-reg move (2).  */
-      const int int_store[3];	/* cost of storing integer register
+      int int_store[3];		/* cost of storing integer register
 				   in QImode, HImode and SImode */
-      const int fp_move;	/* cost of reg,reg fld/fst */
-      const int fp_load[3];	/* cost of loading FP register
+      int fp_move;		/* cost of reg,reg fld/fst */
+      int fp_load[3];		/* cost of loading FP register
 				   in SFmode, DFmode and XFmode */
-      const int fp_store[3];	/* cost of storing FP register
+      int fp_store[3];		/* cost of storing FP register
 				   in SFmode, DFmode and XFmode */
-      const int mmx_move;	/* cost of moving MMX register.  */
-      const int mmx_load[2];	/* cost of loading MMX register
+      int mmx_move;		/* cost of moving MMX register.  */
+      int mmx_load[2];		/* cost of loading MMX register
 				   in SImode and DImode */
-      const int mmx_store[2];	/* cost of storing MMX register
+      int mmx_store[2];		/* cost of storing MMX register
 				   in SImode and DImode */
-      const int xmm_move;	/* cost of moving XMM register.  */
-      const int ymm_move;	/* cost of moving XMM register.  */
-      const int zmm_move;	/* cost of moving XMM register.  */
-      const int sse_load[5];	/* cost of loading SSE register
+      int xmm_move;		/* cost of moving XMM register.  */
+      int ymm_move;		/* cost of moving XMM register.  */
+      int zmm_move;		/* cost of moving XMM register.  */
+      int sse_load[5];		/* cost of loading SSE register
 				   in 32bit, 64bit, 128bit, 256bit and 512bit */
-      const int sse_store[5];	/* cost of storing SSE register
+      int sse_store[5];		/* cost of storing SSE register
 				   in SImode, DImode and TImode.  */
-      const int sse_to_integer;	/* cost of moving SSE register to integer.  */
-      const int integer_to_sse;	/* cost of moving integer register to SSE. */
-      const int mask_to_integer; /* cost of moving mask register to integer.  */
-      const int integer_to_mask; /* cost of moving integer register to mask.  */
-      const int mask_load[3]; /* cost of loading mask registers
+      int sse_to_integer;	/* cost of moving SSE register to integer.  */
+      int integer_to_sse;	/* cost of moving integer register to SSE. */
+      int mask_to_integer;	 /* cost of moving mask register to integer.  */
+      int integer_to_mask;	 /* cost of moving integer register to mask.  */
+      int mask_load[3];	      /* cost of loading mask registers
 				 in QImode, HImode and SImode.  */
-      const int mask_store[3]; /* cost of storing mask register
+      int mask_store[3];       /* cost of storing mask register
 				  in QImode, HImode and SImode.  */
-      const int mask_move; /* cost of moving mask register.  */
+      int mask_move;	   /* cost of moving mask register.  */
     } hard_register;
 
-  const int add;		/* cost of an add instruction */
-  const int lea;		/* cost of a lea instruction */
-  const int shift_var;		/* variable shift costs */
-  const int shift_const;	/* constant shift costs */
-  const int mult_init[5];	/* cost of starting a multiply
+  int add;			/* cost of an add instruction */
+  int lea;			/* cost of a lea instruction */
+  int shift_var;		/* variable shift costs */
+  int shift_const;		/* constant shift costs */
+  int mult_init[5];		/* cost of starting a multiply
 				   in QImode, HImode, SImode, DImode, TImode*/
-  const int mult_bit;		/* cost of multiply per each bit set */
-  const int divide[5];		/* cost of a divide/mod
+  int mult_bit;			/* cost of multiply per each bit set */
+  int divide[5];		/* cost of a divide/mod
 				   in QImode, HImode, SImode, DImode, TImode*/
   int movsx;			/* The cost of movsx operation.  */
   int movzx;			/* The cost of movzx operation.  */
-  const int large_insn;		/* insns larger than this cost more */
-  const int move_ratio;		/* The threshold of number of scalar
+  int large_insn;		/* insns larger than this cost more */
+  int move_ratio;		/* The threshold of number of scalar
 				   memory-to-memory move insns.  */
-  const int clear_ratio;	/* The threshold of number of scalar
+  int clear_ratio;		/* The threshold of number of scalar
 				   memory clearing insns.  */
-  const int int_load[3];	/* cost of loading integer registers
+  int int_load[3];		/* cost of loading integer registers
 				   in QImode, HImode and SImode relative
 				   to reg-reg move (2).  */
-  const int int_store[3];	/* cost of storing integer register
+  int int_store[3];		/* cost of storing integer register
 				   in QImode, HImode and SImode */
-  const int sse_load[5];	/* cost of loading SSE register
+  int sse_load[5];		/* cost of loading SSE register
 				   in 32bit, 64bit, 128bit, 256bit and 512bit */
-  const int sse_store[5];	/* cost of storing SSE register
+  int sse_store[5];		/* cost of storing SSE register
 				   in 32bit, 64bit, 128bit, 256bit and 512bit */
-  const int sse_unaligned_load[5];/* cost of unaligned load.  */
-  const int sse_unaligned_store[5];/* cost of unaligned store.  */
-  const int xmm_move, ymm_move, /* cost of moving XMM and YMM register.  */
+  int sse_unaligned_load[5];/* cost of unaligned load.  */
+  int sse_unaligned_store[5];/* cost of unaligned store.  */
+  int xmm_move, ymm_move,	/* cost of moving XMM and YMM register.  */
 	    zmm_move;
-  const int sse_to_integer;	/* cost of moving SSE register to integer.  */
-  const int gather_static, gather_per_elt; /* Cost of gather load is computed
+  int sse_to_integer;		/* cost of moving SSE register to integer.  */
+  int gather_static, gather_per_elt;	   /* Cost of gather load is computed
 				   as static + per_item * nelts. */
-  const int scatter_static, scatter_per_elt; /* Cost of gather store is
+  int scatter_static, scatter_per_elt;	     /* Cost of gather store is
 				   computed as static + per_item * nelts.  */
-  const int l1_cache_size;	/* size of l1 cache, in kilobytes.  */
-  const int l2_cache_size;	/* size of l2 cache, in kilobytes.  */
-  const int prefetch_block;	/* bytes moved to cache for prefetch.  */
-  const int simultaneous_prefetches; /* number of parallel prefetch
+  int l1_cache_size;		/* size of l1 cache, in kilobytes.  */
+  int l2_cache_size;		/* size of l2 cache, in kilobytes.  */
+  int prefetch_block;		/* bytes moved to cache for prefetch.  */
+  int simultaneous_prefetches;	     /* number of parallel prefetch
 				   operations.  */
-  const int branch_cost;	/* Default value for BRANCH_COST.  */
-  const int fadd;		/* cost of FADD and FSUB instructions.  */
-  const int fmul;		/* cost of FMUL instruction.  */
-  const int fdiv;		/* cost of FDIV instruction.  */
-  const int fabs;		/* cost of FABS instruction.  */
-  const int fchs;		/* cost of FCHS instruction.  */
-  const int fsqrt;		/* cost of FSQRT instruction.  */
+  int branch_cost;		/* Default value for BRANCH_COST.  */
+  int fadd;			/* cost of FADD and FSUB instructions.  */
+  int fmul;			/* cost of FMUL instruction.  */
+  int fdiv;			/* cost of FDIV instruction.  */
+  int fabs;			/* cost of FABS instruction.  */
+  int fchs;			/* cost of FCHS instruction.  */
+  int fsqrt;			/* cost of FSQRT instruction.  */
 				/* Specify what algorithm
 				   to use for stringops on unknown size.  */
-  const int sse_op;		/* cost of cheap SSE instruction.  */
-  const int addss;		/* cost of ADDSS/SD SUBSS/SD instructions.  */
-  const int mulss;		/* cost of MULSS instructions.  */
-  const int mulsd;		/* cost of MULSD instructions.  */
-  const int fmass;		/* cost of FMASS instructions.  */
-  const int fmasd;		/* cost of FMASD instructions.  */
-  const int divss;		/* cost of DIVSS instructions.  */
-  const int divsd;		/* cost of DIVSD instructions.  */
-  const int sqrtss;		/* cost of SQRTSS instructions.  */
-  const int sqrtsd;		/* cost of SQRTSD instructions.  */
-  const int reassoc_int, reassoc_fp, reassoc_vec_int, reassoc_vec_fp;
+  int sse_op;			/* cost of cheap SSE instruction.  */
+  int addss;			/* cost of ADDSS/SD SUBSS/SD instructions.  */
+  int mulss;			/* cost of MULSS instructions.  */
+  int mulsd;			/* cost of MULSD instructions.  */
+  int fmass;			/* cost of FMASS instructions.  */
+  int fmasd;			/* cost of FMASD instructions.  */
+  int divss;			/* cost of DIVSS instructions.  */
+  int divsd;			/* cost of DIVSD instructions.  */
+  int sqrtss;			/* cost of SQRTSS instructions.  */
+  int sqrtsd;			/* cost of SQRTSD instructions.  */
+  int reassoc_int, reassoc_fp, reassoc_vec_int, reassoc_vec_fp;
 				/* Specify reassociation width for integer,
 				   fp, vector integer and vector fp
 				   operations.  Generally should correspond
@@ -207,18 +207,18 @@ struct processor_costs {
 				   parallel.  See also
 				   ix86_reassociation_width.  */
   struct stringop_algs *memcpy, *memset;
-  const int cond_taken_branch_cost;    /* Cost of taken branch for vectorizer
+  int cond_taken_branch_cost;	       /* Cost of taken branch for vectorizer
 					  cost model.  */
-  const int cond_not_taken_branch_cost;/* Cost of not taken branch for
+  int cond_not_taken_branch_cost;/* Cost of not taken branch for
 					  vectorizer cost model.  */
 
   /* The "0:0:8" label alignment specified for some processors generates
      secondary 8-byte alignment only for those label/jump/loop targets
      which have primary alignment.  */
-  const char *const align_loop;		/* Loop alignment.  */
-  const char *const align_jump;		/* Jump alignment.  */
-  const char *const align_label;	/* Label alignment.  */
-  const char *const align_func;		/* Function alignment.  */
+  const char *align_loop;		/* Loop alignment.  */
+  const char *align_jump;		/* Jump alignment.  */
+  const char *align_label;		/* Label alignment.  */
+  const char *align_func;		/* Function alignment.  */
 };
 
 extern const struct processor_costs *ix86_cost;
@@ -1142,6 +1142,7 @@ static stringop_algs amdfam10_memset[2] = {
              {2048, rep_prefix_4_byte, false}, {-1, libcall, false}}},
   {libcall, {{48, unrolled_loop, false}, {8192, rep_prefix_8_byte, false},
              {-1, libcall, false}}}};
+static const
 struct processor_costs amdfam10_cost = {
   {
   /* Start of register allocator costs.  integer->integer move cost is 2. */
@@ -1401,6 +1402,7 @@ static stringop_algs znver1_memset[2] = {
   {libcall, {{48, unrolled_loop, false},
 	     {128, rep_prefix_8_byte, false},
 	     {-1, libcall, false}}}};
+static const
 struct processor_costs znver1_cost = {
   {
   /* Start of register allocator costs.  integer->integer move cost is 2. */
@@ -1554,6 +1556,7 @@ static stringop_algs znver2_memset[2] = {
 	     {128, rep_prefix_8_byte, false},
 	     {-1, libcall, false}}}};
 
+static const
 struct processor_costs znver2_cost = {
   {
   /* Start of register allocator costs.  integer->integer move cost is 2. */
@@ -1688,6 +1691,7 @@ struct processor_costs znver2_cost = {
   "16",					/* Func alignment.  */
 };
 
+static const
 struct processor_costs znver3_cost = {
   {
   /* Start of register allocator costs.  integer->integer move cost is 2. */
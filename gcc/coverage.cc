@@ -94,6 +94,7 @@ static unsigned prg_ctr_mask; /* Mask of counter types generated.  */
 /* Counter information for current function.  */
 static unsigned fn_ctr_mask; /* Mask of counters used.  */
 static GTY(()) tree fn_v_ctrs[GCOV_COUNTERS];   /* counter variables.  */
+static GTY(()) tree fn_v_thread_ctrs; /* per-thread copy of arc counters.  */
 static unsigned fn_n_ctrs[GCOV_COUNTERS]; /* Counters allocated.  */
 static unsigned fn_b_ctrs[GCOV_COUNTERS]; /* Allocation base.  */
 
@@ -425,6 +426,14 @@ coverage_counter_alloc (unsigned counter, unsigned num)
 
       fn_v_ctrs[counter]
 	= build_var (current_function_decl, array_type, counter);
+      if (counter == GCOV_COUNTER_ARCS
+	  && flag_profile_update == PROFILE_UPDATE_PER_THREAD)
+	{
+	  fn_v_thread_ctrs
+	    = build_var (current_function_decl, array_type, GCOV_COUNTERS);
+	  set_decl_tls_model (fn_v_thread_ctrs,
+			      decl_default_tls_model (fn_v_thread_ctrs));
+	}
     }
 
   fn_b_ctrs[counter] = fn_n_ctrs[counter];
@@ -450,6 +459,19 @@ tree_coverage_counter_ref (unsigned counter, unsigned no)
 		 build_int_cst (integer_type_node, no), NULL, NULL);
 }
 
+/* Generate a tree to access the per-thread copy of arc counter NO.  The
+   copy has one more element, which is set once the current thread has
+   registered it with libgcov.  */
+
+tree
+tree_coverage_thread_counter_ref (unsigned no)
+{
+  gcc_assert (fn_v_thread_ctrs && no <= fn_n_ctrs[GCOV_COUNTER_ARCS]);
+
+  return build4 (ARRAY_REF, get_gcov_type (), fn_v_thread_ctrs,
+		 build_int_cst (integer_type_node, no), NULL, NULL);
+}
+
 /* Generate a tree to access the address of COUNTER NO.  */
 
 tree
@@ -712,6 +734,20 @@ coverage_end_function (unsigned lineno_checksum, unsigned cfg_checksum)
       *functions_tail = item;
       functions_tail = &item->next;
 
+      /* The per-thread copy has the extra element telling whether it
+	 is registered.  */
+      if (tree var = fn_v_thread_ctrs)
+	{
+	  tree array_type
+	    = build_index_type (size_int (fn_n_ctrs[GCOV_COUNTER_ARCS]));
+	  array_type = build_array_type (get_gcov_type (), array_type);
+	  TREE_TYPE (var) = array_type;
+	  DECL_SIZE (var) = TYPE_SIZE (array_type);
+	  DECL_SIZE_UNIT (var) = TYPE_SIZE_UNIT (array_type);
+	  varpool_node::finalize_decl (var);
+	  fn_v_thread_ctrs = NULL_TREE;
+	}
+
       for (i = 0; i != GCOV_COUNTERS; i++)
 	{
 	  tree var = fn_v_ctrs[i];
@@ -749,7 +785,8 @@ coverage_remove_note_file (void)
 }
 
 /* Build a coverage variable of TYPE for function FN_DECL.  If COUNTER
-   >= 0 it is a counter array, otherwise it is the function structure.  */
+   >= 0 it is a counter array, or the per-thread copy of the arc counters
+   if it is GCOV_COUNTERS, otherwise it is the function structure.  */
 
 static tree
 build_var (tree fn_decl, tree type, int counter)
@@ -765,6 +802,8 @@ build_var (tree fn_decl, tree type, int counter)
 
   if (counter < 0)
     strcpy (buf, "__gcov__");
+  else if (counter == GCOV_COUNTERS)
+    strcpy (buf, "__gcovt_");
   else
     sprintf (buf, "__gcov%u_", counter);
   len = strlen (buf);
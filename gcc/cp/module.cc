@@ -124,6 +124,14 @@ along with GCC; see the file COPYING3.  If not see
    does mean we can get larger SCCs than if we separated them.  It is
    unclear whether this is a win or not.
 
+   Sections are neither compressed nor written concurrently.  A
+   compressed section could not be used in place from the mapped CMI,
+   so each lazy load would have to decompress it into fresh memory.
+   Streaming out an SCC walks and updates GC-allocated trees and
+   global hash tables, none of which are thread-safe, so clusters
+   cannot be written on worker threads either.  The one pass over all
+   the written bytes, the checksum, is table-driven instead.
+
    Notice that we embed section indices into the contents of other
    sections.  Thus random manipulation of the CMI file by ELF tools
    may well break it.  The kosher way would probably be to introduce
@@ -476,15 +484,43 @@ protected:
   }
 };
 
+/* Lookup tables for calc_crc.  Entry [N][B] is the crc32 of byte B
+   followed by N zero bytes, which allows us to fold in 4 bytes at a
+   time, rather than a nibble at a time as crc32_byte does.  */
+
+static unsigned crc_tables[4][256];
+
 /* Calculate the crc32 of the buffer.  Note the CRC is stored in the
-   first 4 bytes, so don't include them.  */
+   first 4 bytes, so don't include them.  This must produce the same
+   value as accumulating crc32_byte over the buffer.  */
 
 unsigned
 bytes::calc_crc (unsigned l) const
 {
+  if (!crc_tables[0][1])
+    {
+      for (unsigned ix = 0; ix != 256; ix++)
+	crc_tables[0][ix] = crc32_unsigned_n (0, ix, 1);
+      for (unsigned ix = 0; ix != 256; ix++)
+	for (unsigned jx = 1, crc = crc_tables[0][ix]; jx != 4; jx++)
+	  {
+	    crc = (crc << 8) ^ crc_tables[0][crc >> 24];
+	    crc_tables[jx][ix] = crc;
+	  }
+    }
+
+  const unsigned char *ptr = reinterpret_cast<const unsigned char *> (buffer);
   unsigned crc = 0;
-  for (size_t ix = 4; ix < l; ix++)
-    crc = crc32_byte (crc, buffer[ix]);
+  size_t ix = 4;
+  for (; ix + 4 <= l; ix += 4)
+    {
+      crc ^= (unsigned (ptr[ix]) << 24 | unsigned (ptr[ix + 1]) << 16
+	      | unsigned (ptr[ix + 2]) << 8 | unsigned (ptr[ix + 3]));
+      crc = (crc_tables[3][crc >> 24] ^ crc_tables[2][(crc >> 16) & 0xff]
+	     ^ crc_tables[1][(crc >> 8) & 0xff] ^ crc_tables[0][crc & 0xff]);
+    }
+  for (; ix < l; ix++)
+    crc = (crc << 8) ^ crc_tables[0][(crc >> 24) ^ ptr[ix]];
   return crc;
 }
 
@@ -262,8 +262,13 @@ typedef uint64_t gcov_type_unsigned;
 #define GCOV_TAG_SUMMARY_LENGTH (2 * GCOV_WORD_SIZE)
 #define GCOV_TAG_AFDO_FILE_NAMES ((gcov_unsigned_t)0xaa000000)
 #define GCOV_TAG_AFDO_FUNCTION ((gcov_unsigned_t)0xac000000)
+#define GCOV_TAG_AFDO_MODULE_GROUPING ((gcov_unsigned_t)0xae000000)
 #define GCOV_TAG_AFDO_WORKING_SET ((gcov_unsigned_t)0xaf000000)
 
+/* Version of the AutoFDO profile format, written by gcov-tool autofdo
+   and read by -fauto-profile.  */
+#define AUTO_PROFILE_VERSION 2
+
 
 /* Counters that are collected.  */
 
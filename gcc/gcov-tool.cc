@@ -24,6 +24,9 @@ see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
 <http://www.gnu.org/licenses/>.  */
 
 #include "config.h"
+#define INCLUDE_MAP
+#define INCLUDE_STRING
+#define INCLUDE_VECTOR
 #include "system.h"
 #include "coretypes.h"
 #include "tm.h"
@@ -498,6 +501,509 @@ do_overlap (int argc, char **argv)
 }
 
 
+/* A function instance of the AutoFDO profile: either a function or a copy
+   of it inlined at a callsite of another function instance.  */
+
+struct afdo_instance
+{
+  afdo_instance (unsigned n) : name (n), head_count (0) {}
+  ~afdo_instance ();
+
+  /* Index of the function name in the string table.  */
+  unsigned name;
+  /* Number of samples of the entry of the function.  */
+  gcov_type head_count;
+  /* Map from location to the number of samples.  The upper 16 bits of the
+     location are the line offset to the start of the function and the
+     lower 16 bits the discriminator.  */
+  std::map<unsigned, gcov_type> counts;
+  /* Map from location of an indirect call to the number of samples of its
+     targets, indexed by their names.  */
+  std::map<unsigned, std::map<unsigned, gcov_type> > targets;
+  /* Map from callsite, the location of the call without discriminator and
+     the name of the callee, to the instance inlined there.  */
+  std::map<std::pair<unsigned, unsigned>, afdo_instance *> callsites;
+};
+
+afdo_instance::~afdo_instance ()
+{
+  for (auto &c : callsites)
+    delete c.second;
+}
+
+/* The string table of the profile and the map from name to index.  The
+   compiler never looks up the first entry, so it is left empty.  */
+static std::vector<std::string> afdo_names (1);
+static std::map<std::string, unsigned> afdo_name_index;
+
+/* Map from name index to the instance of the function.  */
+static std::map<unsigned, afdo_instance *> afdo_functions;
+
+/* Return the index of NAME in the string table, adding it if needed.  */
+
+static unsigned
+afdo_name (const std::string &name)
+{
+  auto iter = afdo_name_index.find (name);
+  if (iter != afdo_name_index.end ())
+    return iter->second;
+  afdo_names.push_back (name);
+  return afdo_name_index[name] = afdo_names.size () - 1;
+}
+
+/* Return the instance of CALLEE inlined into S at line offset LINE.  */
+
+static afdo_instance *
+afdo_callsite (afdo_instance *s, unsigned line, unsigned callee)
+{
+  afdo_instance *&c = s->callsites[std::make_pair (line & 0xffff0000,
+						   callee)];
+  if (!c)
+    c = new afdo_instance (callee);
+  return c;
+}
+
+/* Return the instance of the function NAME.  */
+
+static afdo_instance *
+afdo_function (unsigned name)
+{
+  afdo_instance *&f = afdo_functions[name];
+  if (!f)
+    f = new afdo_instance (name);
+  return f;
+}
+
+/* Add the samples of FROM to TO.  */
+
+static void
+afdo_merge_instance (afdo_instance *to, const afdo_instance *from)
+{
+  to->head_count += from->head_count;
+  for (auto &c : from->counts)
+    to->counts[c.first] += c.second;
+  for (auto &t : from->targets)
+    for (auto &c : t.second)
+      to->targets[t.first][c.first] += c.second;
+  for (auto &c : from->callsites)
+    afdo_merge_instance (afdo_callsite (to, c.first.first, c.first.second),
+			 c.second);
+}
+
+/* Report a malformed line LINENO of the sample profile FILENAME.  */
+
+static void ATTRIBUTE_NORETURN
+afdo_parse_error (const char *filename, unsigned lineno, const char *msg)
+{
+  fatal_error (input_location, "%s:%u: %s", filename, lineno, msg);
+}
+
+/* Parse the location "LINE[.DISCRIMINATOR]" at *P and return it in the
+   format of the AutoFDO profile, or -1 if it is malformed.  */
+
+static HOST_WIDE_INT
+afdo_parse_location (const char **p)
+{
+  char *end;
+  unsigned long line = strtoul (*p, &end, 10);
+  unsigned long discriminator = 0;
+
+  if (end == *p || line >= (1 << 16))
+    return -1;
+  if (*end == '.')
+    {
+      const char *d = end + 1;
+      discriminator = strtoul (d, &end, 10);
+      if (end == d || discriminator >= (1 << 16))
+	return -1;
+    }
+  *p = end;
+  return (line << 16) | discriminator;
+}
+
+/* Split the "NAME:COUNT" at START of LENGTH characters, storing the name
+   in NAME and the count in COUNT.  Return false if it is malformed.  */
+
+static bool
+afdo_parse_name_count (const char *start, size_t length, std::string *name,
+		       gcov_type *count)
+{
+  std::string token (start, length);
+  size_t colon = token.rfind (':');
+  if (colon == std::string::npos || colon == 0)
+    return false;
+  char *end;
+  *count = strtoll (token.c_str () + colon + 1, &end, 10);
+  if (*end || end == token.c_str () + colon + 1)
+    return false;
+  *name = token.substr (0, colon);
+  return true;
+}
+
+/* Parse the header "NAME:TOTAL:HEAD" of a function profile in LINE and
+   return the instance its samples are added to.  NAME may be a calling
+   context "[CALLER:LINE @ ... @ NAME]", in which case the samples are
+   added to the copy of NAME inlined along the context, and the instance
+   is also recorded in CONTEXTS.  */
+
+static afdo_instance *
+afdo_parse_header (const char *filename, unsigned lineno, const char *line,
+		   std::vector<afdo_instance *> *contexts)
+{
+  std::string header (line);
+  gcov_type total, head;
+
+  size_t colon = header.rfind (':');
+  if (colon == std::string::npos)
+    afdo_parse_error (filename, lineno, "malformed function header");
+  head = strtoll (header.c_str () + colon + 1, NULL, 10);
+  std::string name;
+  if (!afdo_parse_name_count (header.c_str (), colon, &name, &total))
+    afdo_parse_error (filename, lineno, "malformed function header");
+
+  if (name[0] != '[')
+    {
+      afdo_instance *s = afdo_function (afdo_name (name));
+      s->head_count += head;
+      return s;
+    }
+
+  if (name[name.size () - 1] != ']')
+    afdo_parse_error (filename, lineno, "malformed calling context");
+  name = name.substr (1, name.size () - 2);
+
+  /* Walk the frames from the outermost caller down to the function.  */
+  afdo_instance *s = NULL;
+  HOST_WIDE_INT callsite = -1;
+  size_t start = 0;
+  while (true)
+    {
+      size_t at = name.find (" @ ", start);
+      std::string frame = name.substr (start, at == std::string::npos
+				       ? std::string::npos : at - start);
+      std::string fn = frame;
+      if (at != std::string::npos)
+	{
+	  size_t c = frame.rfind (':');
+	  if (c == std::string::npos)
+	    afdo_parse_error (filename, lineno, "malformed calling context");
+	  fn = frame.substr (0, c);
+	}
+      unsigned index = afdo_name (fn);
+      s = s ? afdo_callsite (s, callsite, index) : afdo_function (index);
+      if (at == std::string::npos)
+	break;
+      const char *p = frame.c_str () + fn.size () + 1;
+      callsite = afdo_parse_location (&p);
+      if (callsite < 0 || *p)
+	afdo_parse_error (filename, lineno, "malformed calling context");
+      start = at + 3;
+    }
+  s->head_count += head;
+  if (callsite >= 0)
+    contexts->push_back (s);
+  return s;
+}
+
+/* Parse the sample profile line LINE of the instance S.  If it starts an
+   inlined callsite, return the instance of the callee, otherwise NULL.  */
+
+static afdo_instance *
+afdo_parse_body (const char *filename, unsigned lineno, const char *line,
+		 afdo_instance *s)
+{
+  const char *p = line;
+  HOST_WIDE_INT loc = afdo_parse_location (&p);
+  if (loc < 0 || *p != ':')
+    afdo_parse_error (filename, lineno, "malformed sample line");
+  p++;
+  while (*p == ' ')
+    p++;
+
+  /* An inlined callsite "CALLEE:TOTAL".  */
+  if (!ISDIGIT (*p))
+    {
+      std::string callee;
+      gcov_type total;
+      if (!afdo_parse_name_count (p, strlen (p), &callee, &total))
+	afdo_parse_error (filename, lineno, "malformed callsite");
+      return afdo_callsite (s, loc, afdo_name (callee));
+    }
+
+  /* Samples "COUNT [TARGET:COUNT]...".  */
+  char *end;
+  s->counts[loc] += strtoll (p, &end, 10);
+  p = end;
+  while (true)
+    {
+      while (*p == ' ')
+	p++;
+      if (!*p)
+	break;
+      const char *token = p;
+      while (*p && *p != ' ')
+	p++;
+      std::string target;
+      gcov_type count;
+      if (!afdo_parse_name_count (token, p - token, &target, &count))
+	afdo_parse_error (filename, lineno, "malformed call target");
+      s->targets[loc][afdo_name (target)] += count;
+    }
+  return NULL;
+}
+
+/* Read the text sample profile FILENAME.  */
+
+static void
+afdo_read_text_profile (const char *filename)
+{
+  FILE *f = fopen (filename, "r");
+  if (!f)
+    fatal_error (input_location, "cannot open %s: %m", filename);
+
+  /* The instances whose samples the lines belong to, with the indentation
+     of their lines, or -1 if it is not known yet.  */
+  std::vector<std::pair<afdo_instance *, int> > stack;
+  std::vector<afdo_instance *> contexts;
+  std::string line;
+  unsigned lineno = 0;
+  int c;
+
+  do
+    {
+      c = getc (f);
+      if (c != '\n' && c != EOF)
+	{
+	  line += (char) c;
+	  continue;
+	}
+      lineno++;
+      if (!line.empty () && line[line.size () - 1] == '\r')
+	line.erase (line.size () - 1);
+
+      int indent = line.find_first_not_of (' ');
+      if (indent < 0 || line[indent] == '#' || line[indent] == '!')
+	;
+      else if (indent == 0)
+	{
+	  stack.clear ();
+	  stack.push_back (std::make_pair (afdo_parse_header (filename, lineno,
+							      line.c_str (),
+							      &contexts),
+					   -1));
+	}
+      else if (stack.empty ())
+	afdo_parse_error (filename, lineno, "samples outside of a function");
+      else
+	{
+	  /* Lines belong to the innermost instance they are more indented
+	     than the enclosing callsite of.  */
+	  while (stack.size () > 1)
+	    {
+	      int outer = stack[stack.size () - 2].second;
+	      int inner = stack.back ().second;
+	      if (inner < 0 ? indent > outer : indent >= inner)
+		break;
+	      stack.pop_back ();
+	    }
+	  if (stack.back ().second < 0)
+	    stack.back ().second = indent;
+	  else if (indent != stack.back ().second)
+	    afdo_parse_error (filename, lineno, "unexpected indentation");
+	  afdo_instance *callee
+	    = afdo_parse_body (filename, lineno, line.c_str () + indent,
+			       stack.back ().first);
+	  if (callee)
+	    stack.push_back (std::make_pair (callee, -1));
+	}
+      line.clear ();
+    }
+  while (c != EOF);
+  fclose (f);
+
+  /* Samples attributed to a calling context also count for the function
+     when it is not inlined into the callers of the context.  */
+  for (afdo_instance *s : contexts)
+    afdo_merge_instance (afdo_function (s->name), s);
+}
+
+/* Append VALUE to the section BUF.  */
+
+static void
+afdo_write_unsigned (std::string *buf, gcov_unsigned_t value)
+{
+  buf->append ((const char *) &value, sizeof (value));
+}
+
+/* Append counter VALUE to the section BUF.  */
+
+static void
+afdo_write_counter (std::string *buf, gcov_type value)
+{
+  afdo_write_unsigned (buf, (gcov_unsigned_t) value);
+  afdo_write_unsigned (buf, (gcov_unsigned_t) (value >> 32));
+}
+
+/* Append the function instance S to the section BUF in the format read by
+   function_instance::read_function_instance.  */
+
+static void
+afdo_write_instance (std::string *buf, const afdo_instance *s)
+{
+  std::map<unsigned, gcov_type> counts (s->counts);
+  for (auto &t : s->targets)
+    counts.insert (std::make_pair (t.first, 0));
+
+  afdo_write_unsigned (buf, s->name);
+  afdo_write_unsigned (buf, counts.size ());
+  afdo_write_unsigned (buf, s->callsites.size ());
+  for (auto &c : counts)
+    {
+      auto t = s->targets.find (c.first);
+      afdo_write_unsigned (buf, c.first);
+      afdo_write_unsigned (buf, t == s->targets.end () ? 0 : t->second.size ());
+      afdo_write_counter (buf, c.second);
+      if (t != s->targets.end ())
+	for (auto &target : t->second)
+	  {
+	    /* The kind of the histogram; only indirect call targets are
+	       supported.  */
+	    afdo_write_unsigned (buf, 0);
+	    afdo_write_counter (buf, target.first);
+	    afdo_write_counter (buf, target.second);
+	  }
+    }
+  for (auto &c : s->callsites)
+    {
+      afdo_write_unsigned (buf, c.first.first);
+      afdo_write_instance (buf, c.second);
+    }
+}
+
+/* Write section BUF with TAG to F.  */
+
+static void
+afdo_write_section (FILE *f, gcov_unsigned_t tag, const std::string &buf)
+{
+  gcov_unsigned_t header[2] = { tag, (gcov_unsigned_t) buf.size () };
+  fwrite (header, sizeof (header), 1, f);
+  fwrite (buf.data (), buf.size (), 1, f);
+}
+
+/* Write the AutoFDO profile to OUT.  */
+
+static void
+afdo_write_profile (const char *out)
+{
+  FILE *f = fopen (out, "wb");
+  if (!f)
+    fatal_error (input_location, "cannot open %s: %m", out);
+
+  gcov_unsigned_t header[3] = { GCOV_DATA_MAGIC, AUTO_PROFILE_VERSION, 0 };
+  fwrite (header, sizeof (header), 1, f);
+
+  std::string buf;
+  afdo_write_unsigned (&buf, afdo_names.size ());
+  for (auto &name : afdo_names)
+    {
+      afdo_write_unsigned (&buf, name.size () + 1);
+      buf.append (name.c_str (), name.size () + 1);
+    }
+  afdo_write_section (f, GCOV_TAG_AFDO_FILE_NAMES, buf);
+
+  buf.clear ();
+  afdo_write_unsigned (&buf, afdo_functions.size ());
+  for (auto &fn : afdo_functions)
+    {
+      afdo_write_counter (&buf, fn.second->head_count);
+      afdo_write_instance (&buf, fn.second);
+    }
+  afdo_write_section (f, GCOV_TAG_AFDO_FUNCTION, buf);
+
+  /* The module grouping is not used and has no modules.  */
+  buf.clear ();
+  afdo_write_unsigned (&buf, 0);
+  afdo_write_section (f, GCOV_TAG_AFDO_MODULE_GROUPING, buf);
+
+  if (ferror (f) | fclose (f))
+    fatal_error (input_location, "error writing %s", out);
+
+  if (verbose)
+    fnotice (stdout, "Wrote %u functions to %s\n",
+	     (unsigned) afdo_functions.size (), out);
+}
+
+/* Convert the text sample profile IN to the AutoFDO profile OUT.  */
+
+static int
+profile_autofdo (const char *in, const char *out)
+{
+  afdo_read_text_profile (in);
+  afdo_write_profile (out);
+  for (auto &fn : afdo_functions)
+    delete fn.second;
+  return 0;
+}
+
+/* Usage message for profile conversion.  */
+
+static void
+print_autofdo_usage_message (int error_p)
+{
+  FILE *file = error_p ? stderr : stdout;
+
+  fnotice (file, "  autofdo [options] <file>              Convert a text sample profile to AutoFDO format\n");
+  fnotice (file, "    -o, --output <file>                 Output file\n");
+  fnotice (file, "    -v, --verbose                       Verbose mode\n");
+}
+
+static const struct option autofdo_options[] =
+{
+  { "verbose",                no_argument,       NULL, 'v' },
+  { "output",                 required_argument, NULL, 'o' },
+  { 0, 0, 0, 0 }
+};
+
+/* Print profile conversion usage and exit.  */
+
+static void ATTRIBUTE_NORETURN
+autofdo_usage (void)
+{
+  fnotice (stderr, "Autofdo subcommand usage:");
+  print_autofdo_usage_message (true);
+  exit (FATAL_EXIT_CODE);
+}
+
+/* Driver for profile conversion sub-command.  */
+
+static int
+do_autofdo (int argc, char **argv)
+{
+  int opt;
+  const char *output = "fbdata.afdo";
+
+  optind = 0;
+  while ((opt = getopt_long (argc, argv, "vo:", autofdo_options, NULL)) != -1)
+    {
+      switch (opt)
+        {
+        case 'v':
+          verbose = true;
+          break;
+        case 'o':
+          output = optarg;
+          break;
+        default:
+          autofdo_usage ();
+        }
+    }
+
+  if (argc - optind != 1)
+    autofdo_usage ();
+
+  return profile_autofdo (argv[optind], output);
+}
+
 /* Print a usage message and exit.  If ERROR_P is nonzero, this is an error,
    otherwise the output of --help.  */
 
@@ -514,6 +1020,7 @@ print_usage (int error_p)
   print_merge_usage_message (error_p);
   print_rewrite_usage_message (error_p);
   print_overlap_usage_message (error_p);
+  print_autofdo_usage_message (error_p);
   fnotice (file, "\nFor bug reporting instructions, please see:\n%s.\n",
            bug_report_url);
   exit (status);
@@ -605,6 +1112,8 @@ main (int argc, char **argv)
     return do_rewrite (argc - optind, argv + optind);
   else if (!strcmp (sub_command, "overlap"))
     return do_overlap (argc - optind, argv + optind);
+  else if (!strcmp (sub_command, "autofdo"))
+    return do_autofdo (argc - optind, argv + optind);
 
   print_usage (true);
 }
@@ -801,6 +801,8 @@ gt_pch_restore (FILE *f)
       uintptr_t bias
 	= (uintptr_t) mmi.preferred_base - (uintptr_t) orig_preferred_base;
 
+      timevar_push (TV_PCH_PTR_RELOC);
+
       /* Adjust all the global pointers by bias.  */
       line_table = new_line_table;
       for (rt = gt_ggc_rtab; *rt; rt++)
@@ -855,6 +857,7 @@ gt_pch_restore (FILE *f)
 	  memcpy (uleb128_buf, uleb128_ptr, this_size);
 	  uleb128_ptr = uleb128_buf + this_size;
 	}
+      timevar_pop (TV_PCH_PTR_RELOC);
     }
   else if (fseek (f, (mmi.offset + mmi.size + sizeof (reloc_addrs_size)
 		      + reloc_addrs_size), SEEK_SET) != 0)
@@ -953,11 +956,14 @@ mmap_gt_pch_get_address (size_t size, int fd)
 
 /* Default version of HOST_HOOKS_GT_PCH_USE_ADDRESS when mmap is present.
    Map SIZE bytes of FD+OFFSET at BASE.  Return 1 if we succeeded at
-   mapping the data at BASE, -1 if we couldn't.
+   mapping the data, updating BASE if the kernel placed it elsewhere,
+   -1 if we couldn't.
 
    This version assumes that the kernel honors the START operand of mmap
    even without MAP_FIXED if START through START+SIZE are not currently
-   mapped with something.  */
+   mapped with something.  If it does not, we keep the mapping wherever
+   it landed and let gt_pch_restore relocate it; pages of the image are
+   still only read from the file when first touched.  */
 
 int
 mmap_gt_pch_use_address (void *&base, size_t size, int fd, size_t offset)
@@ -973,7 +979,11 @@ mmap_gt_pch_use_address (void *&base, size_t size, int fd, size_t offset)
   addr = mmap ((caddr_t) base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
 	       fd, offset);
 
-  return addr == base ? 1 : -1;
+  if (addr == (void *) MAP_FAILED)
+    return -1;
+
+  base = addr;
+  return 1;
 }
 #endif /* HAVE_MMAP_FILE */
 
@@ -109,7 +109,7 @@ get_range_strlen (tree, bitmap, strlen_range_kind, c_strlen_data *, unsigned);
         the function body and thus we can't reference the symbol
         directly.  */
 
-static bool
+bool
 can_refer_decl_in_current_unit_p (tree decl, tree from_decl)
 {
   varpool_node *vnode;
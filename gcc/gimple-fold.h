@@ -23,6 +23,7 @@ along with GCC; see the file COPYING3.  If not see
 #define GCC_GIMPLE_FOLD_H
 
 extern tree create_tmp_reg_or_ssa_name (tree, gimple *stmt = NULL);
+extern bool can_refer_decl_in_current_unit_p (tree, tree);
 extern tree canonicalize_constructor_val (tree, tree);
 extern tree get_symbol_constant_value (tree);
 struct c_strlen_data;
@@ -28,8 +28,11 @@ along with GCC; see the file COPYING3.  If not see
      The information is used to set hot/cold thresholds.
    - Next speculative indirect call resolution is performed:  the local
      profile pass assigns profile-id to each function and provide us with a
-     histogram specifying the most common target.  We look up the callgraph
-     node corresponding to the target and produce a speculative call.
+     histogram specifying the most common targets.  We look up the callgraph
+     nodes corresponding to the targets and produce a speculative call with
+     up to --param max-speculative-indirect-call-targets direct calls.
+     Targets of polymorphic calls which are impossible according to the type
+     inheritance graph are ignored.
 
      This call may or may not survive through IPA optimization based on decision
      of inliner. 
@@ -205,6 +208,19 @@ public:
 
 static ipa_profile_call_summaries *call_sums = NULL;
 
+/* Sort speculative call targets by decreasing probability.  */
+
+static int
+speculative_call_target_cmp (const void *pa, const void *pb)
+{
+  const speculative_call_target *a = (const speculative_call_target *) pa;
+  const speculative_call_target *b = (const speculative_call_target *) pb;
+
+  if (a->target_probability != b->target_probability)
+    return a->target_probability < b->target_probability ? 1 : -1;
+  return a->target_id < b->target_id ? -1 : a->target_id > b->target_id;
+}
+
 /* Dump all information in speculative call summary to F.  */
 
 void
@@ -854,12 +870,32 @@ ipa_profile (void)
 	      node_map_initialized = true;
 	      ncommon++;
 
+	      /* Speculate on the most common targets first, up to
+		 --param max-speculative-indirect-call-targets of them.  */
+	      csum->speculative_call_targets.qsort
+		(speculative_call_target_cmp);
 	      unsigned speculative_id = 0;
+	      unsigned max_targets
+		= opt_for_fn (n->decl,
+			      param_max_speculative_indirect_call_targets);
+	      unsigned min_probability
+		= opt_for_fn (n->decl,
+			      param_min_speculative_indirect_call_probability)
+		  * REG_BR_PROB_BASE / 100;
 	      profile_count orig = e->count;
 	      for (unsigned i = 0; i < spec_count; i++)
 		{
 		  speculative_call_target item
 		    = csum->speculative_call_targets[i];
+		  if (speculative_id >= max_targets)
+		    {
+		      nuseless++;
+		      if (dump_file)
+			fprintf (dump_file,
+				 "Not speculating on profile-id %i: "
+				 "too many targets.\n", item.target_id);
+		      continue;
+		    }
 		  n2 = find_func_by_profile_id (item.target_id);
 		  if (n2)
 		    {
@@ -873,7 +909,7 @@ ipa_profile (void)
 				   item.target_probability
 				     / (float) REG_BR_PROB_BASE);
 			}
-		      if (item.target_probability < REG_BR_PROB_BASE / 2)
+		      if (item.target_probability < min_probability)
 			{
 			  nuseless++;
 			  if (dump_file)
@@ -906,7 +942,7 @@ ipa_profile (void)
 				     "parameter count mismatch\n");
 			}
 		      else if (e->indirect_info->polymorphic
-			       && !opt_for_fn (n->decl, flag_devirtualize)
+			       && opt_for_fn (n->decl, flag_devirtualize)
 			       && !possible_polymorphic_call_target_p (e, n2))
 			{
 			  nimpossible++;
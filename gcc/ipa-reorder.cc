@@ -0,0 +1,381 @@
+/* Profile driven function reordering.
+   Copyright (C) 2022 Free Software Foundation, Inc.
+
+This file is part of GCC.
+
+GCC is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3, or (at your option) any later
+version.
+
+GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with GCC; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+/* This pass implements the call-chain clustering (C3) heuristic described
+   in "Optimizing Function Placement for Large-Scale Data-Center
+   Applications" by Ottoni and Maher.  It is enabled by
+   -freorder-functions-algorithm=call-chain-clustering and uses the IPA
+   profile counts of call graph edges, as produced by -fprofile-use or
+   -fauto-profile.
+
+   Every function executed in the train run starts in a cluster of its own.
+   The functions are visited in the order of decreasing density (execution
+   count divided by size) and the cluster of each function is appended to
+   the cluster of its most frequent caller, unless the merged cluster
+   would exceed --param reorder-functions-cluster-size or the merge would
+   make the caller's cluster considerably less dense.  The clusters are
+   finally sorted by density, so the code executed most often ends up
+   packed together and callees follow their callers.
+
+   Clusters whose functions are all executed too rarely to be hot are not
+   placed, so these functions stay in the ordinary text section behind the
+   ordered ones, while never executed functions keep going to
+   .text.unlikely.  This splits the executed code into hot and lukewarm
+   parts on top of the existing hot/cold split.
+
+   The result is recorded in the layout_order field of the call graph
+   nodes and is streamed to the LTRANS units, so with LTO the whole
+   program is ordered at once.  default_function_section then puts the
+   functions into .text.sorted.N sections, which the linker sorts by name
+   and places right after .text.hot.  */
+
+#include "config.h"
+#include "system.h"
+#include "coretypes.h"
+#include "backend.h"
+#include "tree.h"
+#include "gimple.h"
+#include "tree-pass.h"
+#include "cgraph.h"
+#include "alloc-pool.h"
+#include "symbol-summary.h"
+#include "tree-vrp.h"
+#include "ipa-prop.h"
+#include "ipa-fnsummary.h"
+#include "predict.h"
+#include "common/common-target.h"
+
+/* Do not merge clusters if the density of the result drops below the
+   density of the caller's cluster divided by this.  */
+#define MAX_DENSITY_DEGRADATION 8
+
+/* A function considered for placement.  */
+
+struct reorder_function
+{
+  cgraph_node *node;
+  /* Execution count and estimated size of the function.  */
+  gcov_type count;
+  HOST_WIDE_INT size;
+  /* Index of the most frequent caller and the number of calls from it,
+     or -1 and 0 if there is none.  */
+  int best_caller;
+  gcov_type best_caller_count;
+  /* Index of the cluster the function currently belongs to.  */
+  int cluster;
+};
+
+/* A sequence of functions placed next to each other.  */
+
+struct reorder_cluster
+{
+  /* Indices of the functions in the order they are laid out.  */
+  auto_vec<int> functions;
+  /* Sum of execution counts and sizes of the functions.  */
+  gcov_type count;
+  HOST_WIDE_INT size;
+  /* True if some of the functions is hot.  */
+  bool hot;
+};
+
+static vec<reorder_function> functions;
+static vec<reorder_cluster *> clusters;
+
+/* Return true if A is less dense than B.  */
+
+static bool
+less_dense_p (gcov_type count_a, HOST_WIDE_INT size_a,
+	      gcov_type count_b, HOST_WIDE_INT size_b)
+{
+  return (widest_int::from (count_a, SIGNED) * size_b
+	  < widest_int::from (count_b, SIGNED) * size_a);
+}
+
+/* Sort functions by decreasing density.  */
+
+static int
+function_density_cmp (const void *pa, const void *pb)
+{
+  const reorder_function *a = &functions[*(const int *) pa];
+  const reorder_function *b = &functions[*(const int *) pb];
+
+  if (less_dense_p (a->count, a->size, b->count, b->size))
+    return 1;
+  if (less_dense_p (b->count, b->size, a->count, a->size))
+    return -1;
+  return a->node->order - b->node->order;
+}
+
+/* Sort clusters by decreasing density.  */
+
+static int
+cluster_density_cmp (const void *pa, const void *pb)
+{
+  const reorder_cluster *a = *(const reorder_cluster * const *) pa;
+  const reorder_cluster *b = *(const reorder_cluster * const *) pb;
+
+  if (less_dense_p (a->count, a->size, b->count, b->size))
+    return 1;
+  if (less_dense_p (b->count, b->size, a->count, a->size))
+    return -1;
+  return (functions[a->functions[0]].node->order
+	  - functions[b->functions[0]].node->order);
+}
+
+/* Return the index of NODE in FUNCTIONS or -1 if it is not placed.  */
+
+static int
+function_index (cgraph_node *node)
+{
+  return (int) (intptr_t) node->aux - 1;
+}
+
+/* Return true if NODE should be placed by the call-chain clustering.  */
+
+static bool
+reorder_candidate_p (cgraph_node *node)
+{
+  if (!node->definition
+      || node->inlined_to
+      || node->alias
+      || node->thunk
+      || node->no_reorder
+      || !node->count.ipa ().nonzero_p ()
+      || node->frequency == NODE_FREQUENCY_UNLIKELY_EXECUTED
+      || node->only_called_at_startup
+      || node->only_called_at_exit
+      || DECL_SECTION_NAME (node->decl)
+      || !opt_for_fn (node->decl, flag_reorder_functions)
+      || (opt_for_fn (node->decl, flag_reorder_functions_algorithm)
+	  != REORDER_FUNCTIONS_ALGORITHM_C3))
+    return false;
+  ipa_size_summary *s = ipa_size_summaries
+			? ipa_size_summaries->get (node) : NULL;
+  return s && s->size > 0;
+}
+
+/* Determine the most frequent caller of the function with index I.  */
+
+static void
+find_best_caller (int i)
+{
+  reorder_function *f = &functions[i];
+  hash_map<int_hash <int, -1, -2>, gcov_type> counts;
+
+  f->best_caller = -1;
+  f->best_caller_count = 0;
+  for (cgraph_edge *e = f->node->callers; e; e = e->next_caller)
+    {
+      cgraph_node *caller = e->caller->inlined_to
+			    ? e->caller->inlined_to : e->caller;
+      int j = function_index (caller);
+      if (j < 0 || j == i || !e->count.ipa ().nonzero_p ())
+	continue;
+      gcov_type &count = counts.get_or_insert (j);
+      count += e->count.ipa ().to_gcov_type ();
+      if (count > f->best_caller_count
+	  || (count == f->best_caller_count && j < f->best_caller))
+	{
+	  f->best_caller = j;
+	  f->best_caller_count = count;
+	}
+    }
+}
+
+/* Append the cluster with index FROM to the cluster with index TO.  */
+
+static void
+merge_clusters (int to, int from)
+{
+  reorder_cluster *c = clusters[to];
+  reorder_cluster *d = clusters[from];
+  unsigned i;
+  int j;
+
+  FOR_EACH_VEC_ELT (d->functions, i, j)
+    {
+      c->functions.safe_push (j);
+      functions[j].cluster = to;
+    }
+  c->count += d->count;
+  c->size += d->size;
+  c->hot |= d->hot;
+  delete d;
+  clusters[from] = NULL;
+}
+
+/* Compute the placement of the profiled functions.  */
+
+static unsigned int
+ipa_reorder (void)
+{
+  cgraph_node *node;
+  unsigned i;
+  int j;
+
+  FOR_EACH_DEFINED_FUNCTION (node)
+    if (reorder_candidate_p (node))
+      {
+	reorder_function f;
+	f.node = node;
+	f.count = node->count.ipa ().to_gcov_type ();
+	f.size = ipa_size_summaries->get (node)->size;
+	f.best_caller = -1;
+	f.best_caller_count = 0;
+	f.cluster = functions.length ();
+	functions.safe_push (f);
+	node->aux = (void *) (intptr_t) functions.length ();
+      }
+
+  if (functions.length () > 1)
+    {
+      auto_vec<int> sorted (functions.length ());
+
+      for (i = 0; i < functions.length (); i++)
+	{
+	  reorder_function *f = &functions[i];
+	  reorder_cluster *c = new reorder_cluster;
+	  c->functions.safe_push (i);
+	  c->count = f->count;
+	  c->size = f->size;
+	  c->hot = maybe_hot_count_p (NULL, f->node->count.ipa ());
+	  clusters.safe_push (c);
+	  find_best_caller (i);
+	  sorted.quick_push (i);
+	}
+      sorted.qsort (function_density_cmp);
+
+      FOR_EACH_VEC_ELT (sorted, i, j)
+	{
+	  reorder_function *f = &functions[j];
+
+	  /* Ignore callers responsible only for a small part of the
+	     invocations.  */
+	  if (f->best_caller < 0 || f->best_caller_count * 10 <= f->count)
+	    continue;
+	  int to = functions[f->best_caller].cluster;
+	  int from = f->cluster;
+	  if (to == from)
+	    continue;
+	  reorder_cluster *c = clusters[to];
+	  reorder_cluster *d = clusters[from];
+	  if (c->size + d->size > param_reorder_functions_cluster_size)
+	    continue;
+	  if (less_dense_p ((c->count + d->count) * MAX_DENSITY_DEGRADATION,
+			    c->size + d->size, c->count, c->size))
+	    continue;
+	  if (dump_file)
+	    fprintf (dump_file, "Appending cluster of %s to cluster of %s\n",
+		     f->node->dump_name (),
+		     functions[f->best_caller].node->dump_name ());
+	  merge_clusters (to, from);
+	}
+
+      /* Drop the merged clusters.  */
+      unsigned k = 0;
+      for (i = 0; i < clusters.length (); i++)
+	if (clusters[i])
+	  clusters[k++] = clusters[i];
+      clusters.truncate (k);
+      clusters.qsort (cluster_density_cmp);
+
+      int order = 0;
+      reorder_cluster *c;
+      FOR_EACH_VEC_ELT (clusters, i, c)
+	{
+	  if (dump_file)
+	    fprintf (dump_file, "Cluster %u%s: count %" PRId64
+		     ", size %" PRId64 "\n", i, c->hot ? "" : " (not hot)",
+		     (int64_t) c->count, (int64_t) c->size);
+	  unsigned l;
+	  FOR_EACH_VEC_ELT (c->functions, l, j)
+	    {
+	      cgraph_node *n = functions[j].node;
+	      if (c->hot)
+		n->layout_order = ++order;
+	      if (dump_file)
+		fprintf (dump_file, "  %s: count %" PRId64 ", size %" PRId64
+			 ", layout order %i\n", n->dump_name (),
+			 (int64_t) functions[j].count,
+			 (int64_t) functions[j].size, n->layout_order);
+	    }
+	  delete c;
+	}
+    }
+
+  for (i = 0; i < functions.length (); i++)
+    functions[i].node->aux = NULL;
+  functions.release ();
+  clusters.release ();
+  return 0;
+}
+
+namespace {
+
+const pass_data pass_data_ipa_reorder =
+{
+  IPA_PASS, /* type */
+  "reorder", /* name */
+  OPTGROUP_NONE, /* optinfo_flags */
+  TV_IPA_REORDER, /* tv_id */
+  0, /* properties_required */
+  0, /* properties_provided */
+  0, /* properties_destroyed */
+  0, /* todo_flags_start */
+  0, /* todo_flags_finish */
+};
+
+class pass_ipa_reorder : public ipa_opt_pass_d
+{
+public:
+  pass_ipa_reorder (gcc::context *ctxt)
+    : ipa_opt_pass_d (pass_data_ipa_reorder, ctxt,
+		      NULL, /* generate_summary */
+		      NULL, /* write_summary */
+		      NULL, /* read_summary */
+		      NULL, /* write_optimization_summary */
+		      NULL, /* read_optimization_summary */
+		      NULL, /* stmt_fixup */
+		      0, /* function_transform_todo_flags_start */
+		      NULL, /* function_transform */
+		      NULL) /* variable_transform */
+  {}
+
+  /* opt_pass methods: */
+  virtual bool gate (function *);
+  virtual unsigned int execute (function *) { return ipa_reorder (); }
+
+}; // class pass_ipa_reorder
+
+bool
+pass_ipa_reorder::gate (function *)
+{
+  /* reorder_candidate_p checks the options of each function as well.  */
+  return (targetm_common.have_named_sections
+	  && (flag_reorder_functions_algorithm
+	      == REORDER_FUNCTIONS_ALGORITHM_C3));
+}
+
+} // anon namespace
+
+ipa_opt_pass_d *
+make_pass_ipa_reorder (gcc::context *ctxt)
+{
+  return new pass_ipa_reorder (ctxt);
+}
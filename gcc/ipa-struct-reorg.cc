@@ -0,0 +1,927 @@
+/* Interprocedural splitting and field reordering of arrays of structures.
+   Copyright (C) 2022 Free Software Foundation, Inc.
+
+This file is part of GCC.
+
+GCC is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3, or (at your option) any later
+version.
+
+GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with GCC; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+/* This pass changes the memory layout of global arrays of structures
+   whose every use is visible to the compiler, so that hot loops which
+   touch only a few fields of each element do not drag the remaining
+   fields through the cache.
+
+   An array qualifies when it is not visible outside of the program part
+   being compiled (a static variable, or with -flto any variable that
+   whole program visibility made local and that is not referenced from
+   other partitions), has no non-zero initializer, its address is never
+   taken and each of its uses has the form A[I].F, i.e. reads or writes a
+   single field of a single element.  Such an array cannot be reached
+   through pointers, so the layout of its elements is private to the
+   accesses the pass can see and they can be redirected to any other set
+   of arrays.  The analysis tracks variables rather than types: the
+   structure type itself is left alone and other objects of that type are
+   not affected.
+
+   Every field is weighed by the execution counts of the statements
+   accessing it, using profile feedback when it is available and the
+   estimated profile otherwise.  Then
+
+     - fields that are never accessed are removed,
+     - fields whose weight is below --param ipa-struct-reorg-cold-threshold
+       percent of the hottest field are moved to a separate cold array,
+     - the remaining hot fields are partitioned by the hot loops accessing
+       them: fields used together by some hot loop stay in one structure,
+       every other hot field gets an array of its own.  When each hot loop
+       touches a single field this is a full array-of-structures to
+       structure-of-arrays conversion,
+     - within each new structure fields are ordered by decreasing weight.
+
+   The pass runs among the late IPA passes, when function bodies are
+   available both in ordinary compilation and in the LTRANS stage of link
+   time optimization.  */
+
+#include "config.h"
+#include "system.h"
+#include "coretypes.h"
+#include "backend.h"
+#include "tree.h"
+#include "gimple.h"
+#include "tree-pass.h"
+#include "ssa.h"
+#include "cgraph.h"
+#include "stor-layout.h"
+#include "fold-const.h"
+#include "gimple-iterator.h"
+#include "gimple-walk.h"
+#include "gimple-expr.h"
+#include "cfgloop.h"
+#include "tree-ssa-loop-niter.h"
+#include "tree-pretty-print.h"
+#include "sreal.h"
+#include "attribs.h"
+#include "dbgcnt.h"
+#include "diagnostic-core.h"
+
+/* Sets of fields of a candidate are represented as bit masks, which limits
+   the number of fields a candidate structure can have.  */
+typedef unsigned HOST_WIDE_INT sr_field_mask;
+#define SR_MAX_FIELDS HOST_BITS_PER_WIDE_INT
+
+/* Fields of a candidate accessed within one loop of one function and the
+   weight of the hottest of those accesses.  */
+
+struct sr_region
+{
+  function *fun;
+  int loop;
+  sr_field_mask fields;
+  sreal weight;
+};
+
+/* A global array of structures that may be transformed.  */
+
+class sr_candidate
+{
+public:
+  sr_candidate (varpool_node *, tree);
+
+  /* The array variable and the main variant of its element type.  */
+  varpool_node *node;
+  tree record;
+
+  /* Fields of RECORD in declaration order and their weights.  */
+  auto_vec<tree> fields;
+  auto_vec<sreal> weights;
+
+  /* Fields that are accessed at all.  */
+  sr_field_mask accessed;
+
+  /* Loops accessing the array.  */
+  auto_vec<sr_region> regions;
+
+  /* Set if some use of the array cannot be redirected.  */
+  bool escapes;
+
+  /* The new layout: for every field the index of the array holding it
+     (-1 if the field is removed) and its new FIELD_DECL, the new arrays
+     and the index of the array of cold fields, or -1.  */
+  auto_vec<int> field_group;
+  auto_vec<tree> new_fields;
+  auto_vec<tree> new_vars;
+  int cold_group;
+
+  /* Set once the new layout has been created.  */
+  bool transform;
+};
+
+sr_candidate::sr_candidate (varpool_node *vnode, tree rec)
+  : node (vnode), record (rec), accessed (0), escapes (false),
+    cold_group (-1), transform (false)
+{
+  for (tree f = TYPE_FIELDS (rec); f; f = DECL_CHAIN (f))
+    if (TREE_CODE (f) == FIELD_DECL)
+      {
+	fields.safe_push (f);
+	weights.safe_push (sreal (0));
+      }
+}
+
+/* Candidates indexed by their VAR_DECL.  */
+
+static hash_map<tree, sr_candidate *> *sr_candidates;
+
+/* Information passed to the statement walkers.  */
+
+struct sr_walk_data
+{
+  /* Function and loop containing the statement and the weight of its
+     basic block.  */
+  function *fun;
+  int loop;
+  sreal weight;
+
+  /* Set when a candidate access was seen or rewritten.  */
+  bool seen;
+};
+
+/* Record that candidate C cannot be transformed because of REASON.  */
+
+static void
+sr_mark_escaped (sr_candidate *c, const char *reason)
+{
+  if (c->escapes)
+    return;
+  c->escapes = true;
+  if (dump_file)
+    fprintf (dump_file, "  %s escapes: %s\n", c->node->dump_name (),
+	     reason);
+}
+
+/* Return the candidate element type if VNODE is an array of structures
+   that the pass can transform, NULL_TREE otherwise.  */
+
+static tree
+sr_candidate_record (varpool_node *vnode)
+{
+  tree decl = vnode->decl;
+  tree type = TREE_TYPE (decl);
+
+  if (TREE_CODE (type) != ARRAY_TYPE
+      || !TYPE_DOMAIN (type)
+      || !COMPLETE_TYPE_P (type)
+      || TREE_CODE (TYPE_SIZE (type)) != INTEGER_CST)
+    return NULL_TREE;
+  tree rec = TYPE_MAIN_VARIANT (TREE_TYPE (type));
+  if (TREE_CODE (rec) != RECORD_TYPE)
+    return NULL_TREE;
+
+  const char *reason = NULL;
+  if (vnode->externally_visible
+      || vnode->used_from_other_partition
+      || vnode->in_other_partition
+      || vnode->force_output
+      || vnode->forced_by_abi
+      || vnode->alias
+      || vnode->has_aliases_p ()
+      || DECL_EXTERNAL (decl)
+      || DECL_PRESERVE_P (decl))
+    reason = "may be used outside of the compiled code";
+  else if (TREE_THIS_VOLATILE (decl)
+	   || TYPE_VOLATILE (TREE_TYPE (type))
+	   || DECL_THREAD_LOCAL_P (decl)
+	   || DECL_HARD_REGISTER (decl)
+	   || DECL_HAS_VALUE_EXPR_P (decl)
+	   || vnode->get_section ()
+	   || lookup_attribute ("omp declare target", DECL_ATTRIBUTES (decl)))
+    reason = "special variable";
+  else if (TYPE_REVERSE_STORAGE_ORDER (rec)
+	   || TREE_ADDRESSABLE (rec)
+	   || TYPE_TRANSPARENT_AGGR (rec))
+    reason = "special structure type";
+  else
+    {
+      tree init = vnode->get_constructor ();
+      if (init && (init == error_mark_node || !initializer_zerop (init)))
+	reason = "has an initializer";
+    }
+
+  unsigned nfields = 0;
+  for (tree f = TYPE_FIELDS (rec); f && !reason; f = DECL_CHAIN (f))
+    {
+      if (TREE_CODE (f) != FIELD_DECL)
+	continue;
+      if (DECL_BIT_FIELD (f) || DECL_BIT_FIELD_TYPE (f))
+	reason = "has bit-fields";
+      else if (TREE_THIS_VOLATILE (f))
+	reason = "has volatile fields";
+      else if (!DECL_SIZE (f)
+	       || TREE_CODE (DECL_SIZE (f)) != INTEGER_CST
+	       || integer_zerop (DECL_SIZE (f)))
+	reason = "has variable or zero sized fields";
+      else if (++nfields > SR_MAX_FIELDS)
+	reason = "has too many fields";
+    }
+  if (!reason && nfields < 2)
+    reason = "has fewer than two fields";
+
+  ipa_ref *ref;
+  for (unsigned i = 0; !reason && vnode->iterate_referring (i, ref); i++)
+    if (!is_a <cgraph_node *> (ref->referring)
+	|| (ref->use != IPA_REF_LOAD && ref->use != IPA_REF_STORE))
+      reason = "address taken";
+
+  if (reason)
+    {
+      if (dump_file)
+	fprintf (dump_file, "  not considering %s: %s\n",
+		 vnode->dump_name (), reason);
+      return NULL_TREE;
+    }
+  return rec;
+}
+
+/* If the reference T is an access A[I].F to a candidate A, return the
+   candidate and store the index of F to *FIELD.  */
+
+static sr_candidate *
+sr_access_candidate (tree t, unsigned *field)
+{
+  if (TREE_CODE (t) != COMPONENT_REF
+      || TREE_CODE (TREE_OPERAND (t, 0)) != ARRAY_REF)
+    return NULL;
+  tree aref = TREE_OPERAND (t, 0);
+  tree base = TREE_OPERAND (aref, 0);
+  if (!VAR_P (base))
+    return NULL;
+  sr_candidate **slot = sr_candidates->get (base);
+  if (!slot)
+    return NULL;
+
+  sr_candidate *c = *slot;
+  if (TREE_OPERAND (aref, 2)
+      || TREE_OPERAND (aref, 3)
+      || TREE_OPERAND (t, 2)
+      || TYPE_MAIN_VARIANT (TREE_TYPE (aref)) != c->record)
+    {
+      sr_mark_escaped (c, "unusual element reference");
+      return NULL;
+    }
+  tree fld = TREE_OPERAND (t, 1);
+  for (unsigned i = 0; i < c->fields.length (); i++)
+    if (c->fields[i] == fld)
+      {
+	*field = i;
+	return c;
+      }
+  sr_mark_escaped (c, "access to an unknown field");
+  return NULL;
+}
+
+/* Return the candidate VAR_DECL T is, if any.  */
+
+static sr_candidate *
+sr_var_candidate (tree t)
+{
+  if (!VAR_P (t))
+    return NULL;
+  sr_candidate **slot = sr_candidates->get (t);
+  return slot ? *slot : NULL;
+}
+
+/* Record an access to FIELD of candidate C described by WD.  */
+
+static void
+sr_record_access (sr_candidate *c, unsigned field, sr_walk_data *wd)
+{
+  sr_field_mask bit = (sr_field_mask) 1 << field;
+
+  c->weights[field] += wd->weight;
+  c->accessed |= bit;
+
+  sr_region *r = NULL;
+  for (unsigned i = c->regions.length (); i-- > 0; )
+    if (c->regions[i].fun == wd->fun && c->regions[i].loop == wd->loop)
+      {
+	r = &c->regions[i];
+	break;
+      }
+  if (!r)
+    {
+      sr_region nr;
+      nr.fun = wd->fun;
+      nr.loop = wd->loop;
+      nr.fields = 0;
+      nr.weight = sreal (0);
+      r = c->regions.safe_push (nr);
+    }
+  r->fields |= bit;
+  if (r->weight < wd->weight)
+    r->weight = wd->weight;
+  wd->seen = true;
+}
+
+/* Callback of walk_gimple_op recording candidate accesses and uses that
+   prevent a transformation.  */
+
+static tree
+sr_analyze_op (tree *tp, int *walk_subtrees, void *data)
+{
+  struct walk_stmt_info *wi = (struct walk_stmt_info *) data;
+  sr_walk_data *wd = (sr_walk_data *) wi->info;
+  tree t = *tp;
+  unsigned field;
+
+  if (TYPE_P (t))
+    *walk_subtrees = 0;
+  else if (TREE_CODE (t) == ADDR_EXPR)
+    {
+      tree base = get_base_address (TREE_OPERAND (t, 0));
+      if (sr_candidate *c = base ? sr_var_candidate (base) : NULL)
+	{
+	  sr_mark_escaped (c, "address taken");
+	  *walk_subtrees = 0;
+	}
+    }
+  else if (sr_candidate *c = sr_access_candidate (t, &field))
+    {
+      sr_record_access (c, field, wd);
+      *walk_subtrees = 0;
+    }
+  else if (sr_candidate *c = sr_var_candidate (t))
+    sr_mark_escaped (c, "used other than by a field access");
+  return NULL_TREE;
+}
+
+/* True if all functions analyzed have IPA profile counts.  */
+
+static bool sr_use_ipa_counts;
+
+/* Return the weight of the statements in basic block BB of FUN: its
+   estimated frequency relative to the entry of FUN, scaled by the IPA
+   count of the entry when sr_use_ipa_counts.  Weights of different
+   functions are then either all execution counts or all per-invocation
+   frequencies, never a mix of the two.  */
+
+static sreal
+sr_bb_weight (function *fun, basic_block bb)
+{
+  profile_count entry = ENTRY_BLOCK_PTR_FOR_FN (fun)->count;
+  sreal weight = bb->count.to_sreal_scale (entry);
+  if (sr_use_ipa_counts)
+    weight *= sreal (entry.ipa ().to_gcov_type ());
+  return weight;
+}
+
+/* Analyze the uses of candidates in NODE.  Return true if it accesses
+   any.  */
+
+static bool
+sr_analyze_function (cgraph_node *node)
+{
+  function *fun = DECL_STRUCT_FUNCTION (node->decl);
+  sr_walk_data wd;
+  basic_block bb;
+
+  wd.fun = fun;
+  wd.seen = false;
+  push_cfun (fun);
+  FOR_EACH_BB_FN (bb, fun)
+    {
+      struct walk_stmt_info wi;
+      memset (&wi, 0, sizeof (wi));
+      wi.info = &wd;
+      wd.weight = sr_bb_weight (fun, bb);
+      wd.loop = (loops_for_fn (fun) && bb->loop_father
+		 ? bb->loop_father->num : 0);
+
+      for (gphi_iterator gsi = gsi_start_phis (bb); !gsi_end_p (gsi);
+	   gsi_next (&gsi))
+	{
+	  gphi *phi = gsi.phi ();
+	  for (unsigned i = 0; i < gimple_phi_num_args (phi); i++)
+	    walk_tree (gimple_phi_arg_def_ptr (phi, i), sr_analyze_op, &wi,
+		       NULL);
+	}
+      for (gimple_stmt_iterator gsi = gsi_start_bb (bb); !gsi_end_p (gsi);
+	   gsi_next (&gsi))
+	{
+	  gimple *stmt = gsi_stmt (gsi);
+	  if (!is_gimple_debug (stmt))
+	    walk_gimple_op (stmt, sr_analyze_op, &wi);
+	}
+    }
+  pop_cfun ();
+  return wd.seen;
+}
+
+/* Field order used by sr_decide: decreasing weight, then decreasing
+   alignment so that little padding is needed, then declaration order.  */
+
+static int
+sr_field_order_cmp (const void *pa, const void *pb, void *data)
+{
+  sr_candidate *c = (sr_candidate *) data;
+  unsigned a = *(const unsigned *) pa;
+  unsigned b = *(const unsigned *) pb;
+
+  if (c->weights[a] != c->weights[b])
+    return c->weights[a] > c->weights[b] ? -1 : 1;
+  if (DECL_ALIGN (c->fields[a]) != DECL_ALIGN (c->fields[b]))
+    return DECL_ALIGN (c->fields[a]) > DECL_ALIGN (c->fields[b]) ? -1 : 1;
+  return a < b ? -1 : a > b ? 1 : 0;
+}
+
+/* Return the representative of the set of fields containing I.  */
+
+static unsigned
+sr_find (unsigned *leader, unsigned i)
+{
+  while (leader[i] != i)
+    {
+      leader[i] = leader[leader[i]];
+      i = leader[i];
+    }
+  return i;
+}
+
+/* Choose the new layout of candidate C and store it to C->field_group,
+   with ORDER the fields sorted by sr_field_order_cmp.  Return true if it
+   differs from the original one.  */
+
+static bool
+sr_decide (sr_candidate *c, vec<unsigned> &order)
+{
+  unsigned nfields = c->fields.length ();
+  sreal threshold = sreal (param_ipa_struct_reorg_cold_threshold);
+  sreal hundred = sreal (100);
+
+  sreal max_weight = sreal (0);
+  for (unsigned i = 0; i < nfields; i++)
+    if (c->weights[i] > max_weight)
+      max_weight = c->weights[i];
+  if (max_weight == sreal (0))
+    {
+      if (dump_file)
+	fprintf (dump_file, "  %s: no executed accesses\n",
+		 c->node->dump_name ());
+      return false;
+    }
+
+  sr_field_mask hot = 0;
+  for (unsigned i = 0; i < nfields; i++)
+    if ((c->accessed & ((sr_field_mask) 1 << i))
+	&& c->weights[i] * hundred >= max_weight * threshold)
+      hot |= (sr_field_mask) 1 << i;
+
+  /* Fields accessed together by a hot loop stay together.  */
+  sreal max_region = sreal (0);
+  for (unsigned i = 0; i < c->regions.length (); i++)
+    if ((c->regions[i].fields & hot) && c->regions[i].weight > max_region)
+      max_region = c->regions[i].weight;
+
+  unsigned leader[SR_MAX_FIELDS];
+  for (unsigned i = 0; i < nfields; i++)
+    leader[i] = i;
+  for (unsigned i = 0; i < c->regions.length (); i++)
+    {
+      sr_region *r = &c->regions[i];
+      if (r->weight * hundred < max_region * threshold)
+	continue;
+      int first = -1;
+      for (unsigned j = 0; j < nfields; j++)
+	if (r->fields & hot & ((sr_field_mask) 1 << j))
+	  {
+	    if (first < 0)
+	      first = sr_find (leader, j);
+	    else
+	      leader[sr_find (leader, j)] = first;
+	  }
+    }
+
+  for (unsigned i = 0; i < nfields; i++)
+    order.quick_push (i);
+  order.sort (sr_field_order_cmp, c);
+
+  /* Number the groups of hot fields by their hottest member, then add the
+     cold fields as a last group.  */
+  int group_of_leader[SR_MAX_FIELDS];
+  for (unsigned i = 0; i < nfields; i++)
+    group_of_leader[i] = -1;
+  c->field_group.safe_grow (nfields, true);
+  int ngroups = 0;
+  bool removed = false, cold = false;
+  for (unsigned k = 0; k < nfields; k++)
+    {
+      unsigned i = order[k];
+      sr_field_mask bit = (sr_field_mask) 1 << i;
+      if (hot & bit)
+	{
+	  unsigned l = sr_find (leader, i);
+	  if (group_of_leader[l] < 0)
+	    group_of_leader[l] = ngroups++;
+	  c->field_group[i] = group_of_leader[l];
+	}
+      else if (c->accessed & bit)
+	cold = true;
+      else
+	{
+	  c->field_group[i] = -1;
+	  removed = true;
+	}
+    }
+  if (cold)
+    {
+      c->cold_group = ngroups++;
+      for (unsigned i = 0; i < nfields; i++)
+	if ((c->accessed & ~hot) & ((sr_field_mask) 1 << i))
+	  c->field_group[i] = c->cold_group;
+    }
+
+  if (ngroups == 1 && !removed)
+    {
+      bool reordered = false;
+      for (unsigned k = 0; k < nfields; k++)
+	if (order[k] != k)
+	  reordered = true;
+      if (!reordered)
+	{
+	  if (dump_file)
+	    fprintf (dump_file, "  %s: layout is already optimal\n",
+		     c->node->dump_name ());
+	  return false;
+	}
+      /* Reordering alone only helps when an element spans several cache
+	 lines.  */
+      if (compare_tree_int (TYPE_SIZE_UNIT (c->record),
+			    param_l1_cache_line_size) <= 0)
+	{
+	  if (dump_file)
+	    fprintf (dump_file, "  %s: elements fit a cache line\n",
+		     c->node->dump_name ());
+	  return false;
+	}
+    }
+  c->new_vars.safe_grow_cleared (ngroups, true);
+  return true;
+}
+
+/* Create the structure types and arrays of the layout chosen for C, with
+   ORDER the order of fields within them.  */
+
+static void
+sr_create_layout (sr_candidate *c, vec<unsigned> &order)
+{
+  tree decl = c->node->decl;
+  const char *name = (DECL_NAME (decl)
+		      ? IDENTIFIER_POINTER (DECL_NAME (decl)) : "sr");
+  tree type_name = TYPE_IDENTIFIER (c->record);
+  const char *rec_name = type_name ? IDENTIFIER_POINTER (type_name) : "sr";
+
+  c->new_fields.safe_grow_cleared (c->fields.length (), true);
+  for (unsigned g = 0; g < c->new_vars.length (); g++)
+    {
+      /* finish_builtin_struct expects the fields in reverse order.  */
+      tree fields = NULL_TREE;
+      for (unsigned k = 0; k < order.length (); k++)
+	{
+	  unsigned i = order[k];
+	  if (c->field_group[i] != (int) g)
+	    continue;
+	  tree f = c->fields[i];
+	  tree nf = build_decl (DECL_SOURCE_LOCATION (f), FIELD_DECL,
+				DECL_NAME (f), TREE_TYPE (f));
+	  if (DECL_USER_ALIGN (f))
+	    {
+	      SET_DECL_ALIGN (nf, DECL_ALIGN (f));
+	      DECL_USER_ALIGN (nf) = 1;
+	    }
+	  DECL_PACKED (nf) = DECL_PACKED (f);
+	  DECL_NONADDRESSABLE_P (nf) = DECL_NONADDRESSABLE_P (f);
+	  TREE_READONLY (nf) = TREE_READONLY (f);
+	  DECL_ARTIFICIAL (nf) = DECL_ARTIFICIAL (f);
+	  DECL_CHAIN (nf) = fields;
+	  fields = nf;
+	  c->new_fields[i] = nf;
+	}
+
+      tree rec = make_node (RECORD_TYPE);
+      TYPE_PACKED (rec) = TYPE_PACKED (c->record);
+      char *tname = xasprintf ("%s.sr%u", rec_name, g);
+      finish_builtin_struct (rec, tname, fields, NULL_TREE);
+      free (tname);
+
+      tree atype = build_array_type (rec, TYPE_DOMAIN (TREE_TYPE (decl)));
+      tree var = build_decl (DECL_SOURCE_LOCATION (decl), VAR_DECL,
+			     create_tmp_var_name (name), atype);
+      TREE_STATIC (var) = 1;
+      TREE_USED (var) = 1;
+      TREE_READONLY (var) = TREE_READONLY (decl);
+      DECL_ARTIFICIAL (var) = 1;
+      DECL_IGNORED_P (var) = 1;
+      if (DECL_USER_ALIGN (decl) && DECL_ALIGN (decl) > DECL_ALIGN (var))
+	{
+	  SET_DECL_ALIGN (var, DECL_ALIGN (decl));
+	  DECL_USER_ALIGN (var) = 1;
+	}
+      varpool_node::add (var);
+      c->new_vars[g] = var;
+    }
+  c->transform = true;
+}
+
+/* Report the transformation of candidate C under -fopt-info-ipa, with
+   ORDER the order of fields in the new structures.  */
+
+static void
+sr_report (sr_candidate *c, vec<unsigned> &order)
+{
+  if (!dump_enabled_p ())
+    return;
+
+  unsigned ngroups = c->new_vars.length ();
+  unsigned nhot = c->cold_group >= 0 ? ngroups - 1 : ngroups;
+  bool removed = false, all_single = true;
+  for (unsigned g = 0; g < nhot; g++)
+    {
+      unsigned n = 0;
+      for (unsigned i = 0; i < c->fields.length (); i++)
+	n += c->field_group[i] == (int) g;
+      all_single &= n == 1;
+    }
+  for (unsigned i = 0; i < c->fields.length (); i++)
+    removed |= c->field_group[i] < 0;
+
+  const char *kind;
+  if (ngroups == 1)
+    kind = removed ? "removed unused fields" : "reordered fields";
+  else if (nhot > 1 && all_single)
+    kind = "structure of arrays";
+  else if (nhot > 1)
+    kind = "split by loop affinity";
+  else
+    kind = "split cold fields";
+
+  tree decl = c->node->decl;
+  dump_user_location_t loc
+    = dump_user_location_t::from_location_t (DECL_SOURCE_LOCATION (decl));
+  dump_printf_loc (MSG_OPTIMIZED_LOCATIONS, loc, "array %T of %T: %s;",
+		   decl, c->record, kind);
+  for (unsigned g = 0; g < ngroups; g++)
+    {
+      const char *sep = "";
+      dump_printf (MSG_OPTIMIZED_LOCATIONS, " {");
+      for (unsigned k = 0; k < order.length (); k++)
+	if (c->field_group[order[k]] == (int) g)
+	  {
+	    dump_printf (MSG_OPTIMIZED_LOCATIONS, "%s%T", sep,
+			 c->fields[order[k]]);
+	    sep = ", ";
+	  }
+      dump_printf (MSG_OPTIMIZED_LOCATIONS, "}%s",
+		   (int) g == c->cold_group ? " (cold)" : "");
+    }
+  if (removed)
+    {
+      dump_printf (MSG_OPTIMIZED_LOCATIONS, "; removed");
+      for (unsigned i = 0; i < c->fields.length (); i++)
+	if (c->field_group[i] < 0)
+	  dump_printf (MSG_OPTIMIZED_LOCATIONS, " %T", c->fields[i]);
+    }
+  dump_printf (MSG_OPTIMIZED_LOCATIONS, "\n");
+}
+
+/* Callback of walk_gimple_op redirecting accesses to transformed
+   candidates to the new arrays.  */
+
+static tree
+sr_rewrite_op (tree *tp, int *walk_subtrees, void *data)
+{
+  struct walk_stmt_info *wi = (struct walk_stmt_info *) data;
+  sr_walk_data *wd = (sr_walk_data *) wi->info;
+  tree t = *tp;
+  unsigned field;
+
+  if (TYPE_P (t))
+    {
+      *walk_subtrees = 0;
+      return NULL_TREE;
+    }
+  sr_candidate *c = sr_access_candidate (t, &field);
+  if (!c || !c->transform)
+    return NULL_TREE;
+
+  tree aref = TREE_OPERAND (t, 0);
+  tree var = c->new_vars[c->field_group[field]];
+  tree naref = build4 (ARRAY_REF, TREE_TYPE (TREE_TYPE (var)), var,
+		       TREE_OPERAND (aref, 1), NULL_TREE, NULL_TREE);
+  TREE_THIS_NOTRAP (naref) = TREE_THIS_NOTRAP (aref);
+  *tp = build3 (COMPONENT_REF, TREE_TYPE (t), naref, c->new_fields[field],
+		NULL_TREE);
+  *walk_subtrees = 0;
+  wd->seen = true;
+  return NULL_TREE;
+}
+
+/* Callback of walk_tree looking for transformed candidates.  */
+
+static tree
+sr_find_transformed (tree *tp, int *walk_subtrees, void *)
+{
+  if (TYPE_P (*tp))
+    *walk_subtrees = 0;
+  else if (sr_candidate *c = sr_var_candidate (*tp))
+    if (c->transform)
+      return *tp;
+  return NULL_TREE;
+}
+
+/* Redirect the accesses to transformed candidates in NODE.  */
+
+static void
+sr_rewrite_function (cgraph_node *node)
+{
+  function *fun = DECL_STRUCT_FUNCTION (node->decl);
+  basic_block bb;
+
+  push_cfun (fun);
+  FOR_EACH_BB_FN (bb, fun)
+    for (gimple_stmt_iterator gsi = gsi_start_bb (bb); !gsi_end_p (gsi);
+	 gsi_next (&gsi))
+      {
+	gimple *stmt = gsi_stmt (gsi);
+	if (is_gimple_debug (stmt))
+	  {
+	    if (gimple_debug_bind_p (stmt)
+		&& gimple_debug_bind_has_value_p (stmt)
+		&& walk_tree (gimple_debug_bind_get_value_ptr (stmt),
+			      sr_find_transformed, NULL, NULL))
+	      {
+		gimple_debug_bind_reset_value (stmt);
+		update_stmt (stmt);
+	      }
+	    continue;
+	  }
+
+	sr_walk_data wd;
+	struct walk_stmt_info wi;
+	memset (&wi, 0, sizeof (wi));
+	wd.seen = false;
+	wi.info = &wd;
+	walk_gimple_op (stmt, sr_rewrite_op, &wi);
+	if (wd.seen)
+	  update_stmt (stmt);
+      }
+
+  if (loops_for_fn (fun))
+    free_numbers_of_iterations_estimates (fun);
+  cgraph_edge::rebuild_references ();
+  pop_cfun ();
+}
+
+/* Main entry point of the pass.  */
+
+static unsigned int
+ipa_struct_reorg_execute (void)
+{
+  auto_vec<sr_candidate *> candidates;
+  varpool_node *vnode;
+  cgraph_node *node;
+
+  sr_candidates = new hash_map<tree, sr_candidate *>;
+  if (dump_file)
+    fprintf (dump_file, "Looking for candidate arrays:\n");
+  FOR_EACH_DEFINED_VARIABLE (vnode)
+    if (tree rec = sr_candidate_record (vnode))
+      {
+	sr_candidate *c = new sr_candidate (vnode, rec);
+	sr_candidates->put (vnode->decl, c);
+	candidates.safe_push (c);
+      }
+
+  auto_vec<cgraph_node *> users;
+  if (!candidates.is_empty ())
+    {
+      if (dump_file)
+	fprintf (dump_file, "\nAnalyzing accesses:\n");
+      /* Profile feedback provides execution counts that are comparable
+	 across functions, but only if every function has them.  */
+      sr_use_ipa_counts = true;
+      FOR_EACH_DEFINED_FUNCTION (node)
+	if (node->has_gimple_body_p ()
+	    && !node->in_other_partition
+	    && !node->inlined_to
+	    && !node->count.ipa ().initialized_p ())
+	  {
+	    sr_use_ipa_counts = false;
+	    break;
+	  }
+      FOR_EACH_DEFINED_FUNCTION (node)
+	{
+	  /* Nodes without a body in this partition cannot refer to the
+	     candidates, see sr_candidate_record.  */
+	  if (!node->has_gimple_body_p ()
+	      || node->in_other_partition
+	      || node->inlined_to)
+	    continue;
+	  node->get_body ();
+	  if (sr_analyze_function (node))
+	    users.safe_push (node);
+	}
+    }
+
+  bool changed = false;
+  for (unsigned i = 0; i < candidates.length (); i++)
+    {
+      sr_candidate *c = candidates[i];
+      if (c->escapes)
+	continue;
+
+      if (dump_file && (dump_flags & TDF_DETAILS))
+	{
+	  fprintf (dump_file, "\nCandidate %s:\n", c->node->dump_name ());
+	  for (unsigned j = 0; j < c->fields.length (); j++)
+	    {
+	      fprintf (dump_file, "  field ");
+	      print_generic_expr (dump_file, c->fields[j]);
+	      fprintf (dump_file, " weight %f\n", c->weights[j].to_double ());
+	    }
+	}
+
+      auto_vec<unsigned, SR_MAX_FIELDS> order;
+      if (sr_decide (c, order) && dbg_cnt (ipa_struct_reorg))
+	{
+	  sr_create_layout (c, order);
+	  sr_report (c, order);
+	  changed = true;
+	}
+    }
+
+  if (changed)
+    for (unsigned i = 0; i < users.length (); i++)
+      sr_rewrite_function (users[i]);
+
+  for (unsigned i = 0; i < candidates.length (); i++)
+    delete candidates[i];
+  delete sr_candidates;
+  sr_candidates = NULL;
+
+  return changed ? TODO_remove_functions : 0;
+}
+
+namespace {
+
+const pass_data pass_data_ipa_struct_reorg =
+{
+  SIMPLE_IPA_PASS, /* type */
+  "struct-reorg", /* name */
+  OPTGROUP_IPA, /* optinfo_flags */
+  TV_IPA_STRUCT_REORG, /* tv_id */
+  0, /* properties_required */
+  0, /* properties_provided */
+  0, /* properties_destroyed */
+  0, /* todo_flags_start */
+  0, /* todo_flags_finish */
+};
+
+class pass_ipa_struct_reorg : public simple_ipa_opt_pass
+{
+public:
+  pass_ipa_struct_reorg (gcc::context *ctxt)
+    : simple_ipa_opt_pass (pass_data_ipa_struct_reorg, ctxt)
+  {}
+
+  /* opt_pass methods: */
+  virtual bool gate (function *)
+    {
+      return (optimize
+	      && flag_ipa_struct_reorg
+	      /* Don't bother doing anything if the program has errors.  */
+	      && !seen_error ());
+    }
+
+  virtual unsigned int execute (function *)
+    {
+      return ipa_struct_reorg_execute ();
+    }
+
+}; // class pass_ipa_struct_reorg
+
+} // anon namespace
+
+simple_ipa_opt_pass *
+make_pass_ipa_struct_reorg (gcc::context *ctxt)
+{
+  return new pass_ipa_struct_reorg (ctxt);
+}
@@ -1529,6 +1529,9 @@ branch_prob (bool thunk)
 
       /* Commit changes done by instrumentation.  */
       gsi_commit_edge_inserts ();
+
+      if (flag_profile_update == PROFILE_UPDATE_PER_THREAD)
+	gimple_gen_thread_counters_register (num_instrumented);
     }
 
   free_aux_for_edges ();
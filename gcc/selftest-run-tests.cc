@@ -102,6 +102,7 @@ selftest::run_tests ()
   tree_cfg_cc_tests ();
   tree_diagnostic_path_cc_tests ();
   attribs_cc_tests ();
+  auto_profile_cc_tests ();
 
   /* This one relies on most of the above.  */
   function_tests_cc_tests ();
@@ -219,6 +219,7 @@ class test_runner
 /* Declarations for specific families of tests (by source file), in
    alphabetical order.  */
 extern void attribs_cc_tests ();
+extern void auto_profile_cc_tests ();
 extern void bitmap_cc_tests ();
 extern void cgraph_cc_tests ();
 extern void convert_cc_tests ();
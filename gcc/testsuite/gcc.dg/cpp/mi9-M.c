@@ -0,0 +1,12 @@
+/* { dg-do preprocess } */
+/* { dg-options "-M" } */
+
+/* Test that a guarded header skipped under a second spelling is still
+   listed under that spelling in the dependencies.  */
+
+#include "mi9a.h"
+#include "inc/../mi9a.h"
+
+/* { dg-final { scan-file mi9-M.i "(^|\\n)mi9-M.o:" } }
+   { dg-final { scan-file mi9-M.i "\[ \t\]mi9a.h" } }
+   { dg-final { scan-file mi9-M.i "inc/../mi9a.h" } } */
@@ -0,0 +1,17 @@
+/* Test "ignore redundant include" facility for a guarded header
+   reached through different spellings.
+
+   -H is used because cpp might confuse the issue by optimizing out
+   #line markers.  This test only passes if mi9a.h is read once under
+   its second spelling, after its guard has been undefined.  */
+
+/* { dg-do preprocess }
+   { dg-options "-H" }
+   { dg-message "mi9a\.h\n\[^\n\]*mi9b\.h\n\[^\n\]*mi9c\.h\n\[^\n\]*inc/\.\./mi9a\.h" "redundant include check" { target *-*-* } 0 } */
+
+#include "mi9a.h"
+#include "mi9b.h"
+#include "inc/../mi9a.h"
+#include "mi9c.h"
+#undef GUARD9A
+#include "inc/../mi9a.h"
@@ -0,0 +1,3 @@
+#ifndef GUARD9A
+#define GUARD9A
+#endif
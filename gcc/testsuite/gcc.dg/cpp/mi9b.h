@@ -0,0 +1,3 @@
+#ifndef GUARD9B
+#define GUARD9B
+#endif
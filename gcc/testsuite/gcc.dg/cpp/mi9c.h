@@ -0,0 +1,3 @@
+#ifndef GUARD9C
+#define GUARD9C
+#endif
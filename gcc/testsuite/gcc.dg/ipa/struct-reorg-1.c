@@ -0,0 +1,51 @@
+/* { dg-do compile } */
+/* { dg-options "-O2 -fipa-struct-reorg -fdump-ipa-struct-reorg-details" } */
+
+struct S
+{
+  double x;
+  double y;
+  int tag;
+  double z;
+  char name[32];
+};
+
+static struct S a[1024];
+
+void
+init (void)
+{
+  for (int i = 0; i < 1024; i++)
+    {
+      a[i].x = i;
+      a[i].y = 2 * i;
+      a[i].z = 0;
+      a[i].tag = i;
+    }
+}
+
+double
+sum (void)
+{
+  double s = 0;
+  for (int t = 0; t < 1000; t++)
+    for (int i = 0; i < 1024; i++)
+      s += a[i].x;
+  return s;
+}
+
+void
+scale (void)
+{
+  for (int t = 0; t < 1000; t++)
+    for (int i = 0; i < 1024; i++)
+      a[i].y *= 0.5;
+}
+
+int
+get_tag (int i)
+{
+  return a[i].tag + (int) a[i].z;
+}
+
+/* { dg-final { scan-ipa-dump "array a of struct S: structure of arrays; \\{x\\} \\{y\\} \\{z, tag\\} \\(cold\\); removed name" "struct-reorg" } } */
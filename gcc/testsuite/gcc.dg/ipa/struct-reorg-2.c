@@ -0,0 +1,44 @@
+/* { dg-do run } */
+/* { dg-options "-O2 -fipa-struct-reorg -fdump-ipa-struct-reorg-details" } */
+
+struct S
+{
+  int a;
+  double b;
+  int c;
+  long d;
+};
+
+static struct S arr[256];
+static struct S other[4];
+struct S *volatile ptr = other;
+
+int
+main (void)
+{
+  long s = 0;
+
+  for (int i = 0; i < 256; i++)
+    {
+      arr[i].a = i;
+      arr[i].c = 3 * i;
+    }
+  for (int t = 0; t < 50; t++)
+    for (int i = 0; i < 256; i++)
+      s += arr[i].a;
+  for (int i = 0; i < 256; i++)
+    arr[i].d = arr[i].c + 1;
+  for (int i = 0; i < 256; i++)
+    if (arr[i].d != 3 * i + 1)
+      __builtin_abort ();
+  if (s != 50 * (255 * 256 / 2))
+    __builtin_abort ();
+
+  ptr[2].b = 1.5;
+  if (other[2].b != 1.5)
+    __builtin_abort ();
+  return 0;
+}
+
+/* { dg-final { scan-ipa-dump "array arr of struct S:" "struct-reorg" } } */
+/* { dg-final { scan-ipa-dump "not considering other/\[0-9\]+: address taken" "struct-reorg" } } */
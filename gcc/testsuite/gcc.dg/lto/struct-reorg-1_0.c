@@ -0,0 +1,31 @@
+/* { dg-lto-do run } */
+/* { dg-lto-options { { -O2 -flto -flto-partition=one -fipa-struct-reorg -fopt-info-ipa } } } */
+
+/* Test that an array visible to other units is transformed once
+   whole-program visibility makes it local to the program.  */
+
+#include "struct-reorg-1_0.h"
+
+struct S a[N]; /* { dg-lto-message "optimized: array a of struct S: " } */
+
+void
+init (void)
+{
+  for (int i = 0; i < N; i++)
+    {
+      a[i].x = i;
+      a[i].y = 2 * i;
+      a[i].tag = i;
+      a[i].z = 0;
+    }
+}
+
+double
+sum (void)
+{
+  double s = 0;
+  for (int t = 0; t < 100; t++)
+    for (int i = 0; i < N; i++)
+      s += a[i].x;
+  return s;
+}
@@ -0,0 +1,13 @@
+#define N 1024
+
+struct S
+{
+  double x;
+  double y;
+  int tag;
+  double z;
+  char name[32];
+};
+
+extern void init (void);
+extern double sum (void);
@@ -0,0 +1,24 @@
+#include "struct-reorg-1_0.h"
+
+extern struct S a[N];
+
+void
+scale (void)
+{
+  for (int t = 0; t < 100; t++)
+    for (int i = 0; i < N; i++)
+      a[i].y *= 0.5;
+}
+
+int
+main (void)
+{
+  init ();
+  if (sum () != 100.0 * N * (N - 1) / 2)
+    __builtin_abort ();
+  scale ();
+  for (int i = 0; i < N; i++)
+    if (a[i].y != 2.0 * i / 0x1p100 || a[i].tag + (int) a[i].z != i)
+      __builtin_abort ();
+  return 0;
+}
@@ -0,0 +1,42 @@
+/* { dg-options "-O2 -pthread -fprofile-update=per-thread -fdump-ipa-profile" } */
+/* { dg-require-effective-target tls_native } */
+/* { dg-require-effective-target pthread } */
+
+#include <pthread.h>
+
+#define NUM_THREADS 8
+#define ITERATIONS 100000
+
+volatile int sink;
+
+__attribute__ ((noipa)) void
+work (int i)
+{
+  if (i % 4 == 0)
+    sink = i;
+}
+
+void *
+thread_fn (void *d)
+{
+  for (int i = 0; i < ITERATIONS; i++)
+    work (i);
+  return d;
+}
+
+int
+main (void)
+{
+  pthread_t threads[NUM_THREADS];
+
+  for (int t = 0; t < NUM_THREADS; t++)
+    if (pthread_create (&threads[t], NULL, thread_fn, 0))
+      return 1;
+  for (int t = 0; t < NUM_THREADS; t++)
+    pthread_join (threads[t], NULL);
+  return 0;
+}
+
+/* The counts of the threads are merged when they exit, without losing
+   any.  */
+/* { dg-final-use-not-autofdo { scan-ipa-dump "work/\[0-9\]+ .*count:800000 \\\(precise\\\)" "profile" } } */
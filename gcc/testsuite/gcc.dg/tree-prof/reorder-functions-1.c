@@ -0,0 +1,50 @@
+/* { dg-require-named-sections "" } */
+/* { dg-options "-O2 -fno-inline -freorder-functions-algorithm=call-chain-clustering -fdump-ipa-reorder" } */
+
+int v;
+
+__attribute__ ((noinline, noipa))
+void
+leaf (int i)
+{
+  v += i;
+}
+
+__attribute__ ((noinline))
+void
+hot (int i)
+{
+  leaf (i);
+  leaf (i + 1);
+}
+
+__attribute__ ((noinline))
+void
+lukewarm (void)
+{
+  v--;
+}
+
+__attribute__ ((noinline))
+void
+never (void)
+{
+  v = 0;
+}
+
+int
+main (void)
+{
+  for (int i = 0; i < 1000000; i++)
+    hot (i);
+  lukewarm ();
+  if (v == 42)
+    never ();
+  return 0;
+}
+
+/* { dg-final-use { scan-ipa-dump "Appending cluster of leaf\[^\n\]* to cluster of hot" "reorder" } } */
+/* { dg-final-use { scan-ipa-dump "lukewarm\[^\n\]*, layout order 0" "reorder" } } */
+/* { dg-final-use { scan-assembler "\\.text\\.sorted\\.0000000001" } } */
+/* { dg-final-use { scan-assembler "\\.text\\.sorted\\.0000000002" } } */
+/* { dg-final-use-not-autofdo { scan-assembler "\\.text\\.unlikely" } } */
@@ -0,0 +1,27 @@
+/* { dg-options "-O2 -fdump-ipa-profile-optimized" } */
+
+float a[1000], b[1000];
+
+__attribute__ ((noipa)) void
+scale (float *x, const float *y, int n, long stride)
+{
+  for (int i = 0; i < n; i++)
+    {
+      *x = *y * 2.0f;
+      x += stride;
+      y += stride;
+    }
+}
+
+int
+main ()
+{
+  for (int i = 0; i < 1000; i++)
+    scale (a + (i % 100), b + (i % 100), 8, 3);
+  scale (a, b, 100, 1);
+  return 0;
+}
+
+/* autofdo does not do value profiling so far */
+/* { dg-final-use-not-autofdo { scan-ipa-dump "Transformation done: versioned loop for n_\[0-9\]*\\(D\\) == 8" "profile" } } */
+/* { dg-final-use-not-autofdo { scan-ipa-dump "Transformation done: versioned loop for stride_\[0-9\]*\\(D\\) == 3" "profile" } } */
@@ -0,0 +1,28 @@
+/* { dg-do compile } */
+/* { dg-options "-O -fprofile-arcs -fprofile-update=per-thread -fdump-tree-lim2-details" } */
+/* { dg-require-profiling "-fprofile-generate" } */
+/* { dg-require-effective-target tls_native } */
+
+struct thread_param
+{
+  long* buf;
+  long iterations;
+  long accesses;
+} param;
+
+void access_buf(struct thread_param* p)
+{
+  long i,j;
+  long iterations = p->iterations;
+  long accesses = p->accesses;
+  for (i=0; i<iterations; i++)
+    {
+      long* pbuf = p->buf;
+      for (j=0; j<accesses; j++)
+	pbuf[j] += 1;
+    }
+}
+
+/* The per-thread counters can be promoted out of the loops just like the
+   counters of the single mode.  */
+/* { dg-final { scan-tree-dump-times "Executing store motion of __gcovt.access_buf\\\[\[12\]\\\] from loop 1" 2 "lim2" } } */
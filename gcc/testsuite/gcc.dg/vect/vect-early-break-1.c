@@ -0,0 +1,77 @@
+/* { dg-require-effective-target vect_int } */
+
+#include "tree-vect.h"
+
+#define N 256
+
+int a[N + 16];
+
+__attribute__ ((noipa)) int
+find (int *p, int n, int x)
+{
+  int i;
+  for (i = 0; i < n; i++)
+    if (p[i] == x)
+      break;
+  return i;
+}
+
+__attribute__ ((noipa)) int
+len (int *p)
+{
+  int i = 0;
+  while (p[i] != 0)
+    i++;
+  return i;
+}
+
+/* The invariant is computed before the loop and compared first, and the
+   counting exit is tested before the data dependent one.  */
+
+__attribute__ ((noipa)) int
+find_scaled (int *p, int n, int x)
+{
+  int y = x * 3;
+  int i = 0;
+  while (1)
+    {
+      if (i >= n)
+	break;
+      if (y == p[i])
+	break;
+      i++;
+    }
+  return i;
+}
+
+int
+main (void)
+{
+  check_vect ();
+
+  for (int i = 0; i < N + 16; i++)
+    {
+      a[i] = i + 1;
+      asm volatile ("" ::: "memory");
+    }
+  a[N] = 0;
+
+  for (int s = 0; s < 8; s++)
+    {
+      for (int j = s; j < N; j += 7)
+	{
+	  if (find (a + s, N - s, j + 1) != j - s)
+	    abort ();
+	  if (find (a + s, j - s, j + 1) != j - s)
+	    abort ();
+	  if (find_scaled (a + s, N - s, j + 1)
+	      != (3 * (j + 1) <= N ? 3 * (j + 1) - 1 - s : N - s))
+	    abort ();
+	}
+      if (len (a + s) != N - s)
+	abort ();
+    }
+  return 0;
+}
+
+/* { dg-final { scan-tree-dump-times "early exit loop vectorized" 3 "vect" { target lp64 } } } */
@@ -0,0 +1,19 @@
+/* { dg-do compile } */
+/* { dg-require-effective-target vect_int } */
+/* { dg-additional-options "-fsanitize=address" } */
+/* { dg-skip-if "no address sanitizer" { no_fsanitize_address } } */
+
+/* The speculative vector loads may read past the end of the object, which
+   the address sanitizer would report.  */
+
+int
+find (int *p, int n, int x)
+{
+  int i;
+  for (i = 0; i < n; i++)
+    if (p[i] == x)
+      break;
+  return i;
+}
+
+/* { dg-final { scan-tree-dump-not "early exit loop vectorized" "vect" } } */
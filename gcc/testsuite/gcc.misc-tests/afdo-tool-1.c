@@ -0,0 +1,17 @@
+/* Compiled with the profile converted by gcov-tool-autofdo.exp.  */
+
+int bar (int);
+
+int
+foo (int x)
+{
+  return x > 10 ? x * 3 : x + 1;
+}
+
+int
+main (int argc, char **argv)
+{
+  int (*fp) (int) = argc > 1 ? foo : bar;
+  int s = fp (argc);
+  return s + foo (argc);
+}
@@ -0,0 +1,34 @@
+/* Test that forked children keep dumping the profile periodically when
+   GCOV_DUMP_INTERVAL is set.  */
+
+/* { dg-options "-fprofile-arcs -ftest-coverage -pthread" } */
+/* { dg-do run { target { native && { pthread && fork } } } } */
+/* { dg-set-target-env-var GCOV_DUMP_INTERVAL "1" } */
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int
+main (void)
+{
+  int s = 0;
+  pid_t pid = fork ();
+
+  if (pid == 0)
+    {
+      for (int i = 0; i < 10; i++)
+	s += i;			/* count(10) */
+
+      /* Leave without the dump at exit, so that only the periodic dumps
+	 of the child record the loop.  */
+      sleep (3);
+      _exit (s == 45 ? 0 : 1);
+    }
+
+  int status;
+  waitpid (pid, &status, 0);
+  return !WIFEXITED (status) || WEXITSTATUS (status) != 0;
+}
+
+/* { dg-final { run-gcov gcov-dump-interval-1.c } } */
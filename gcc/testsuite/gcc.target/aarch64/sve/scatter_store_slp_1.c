@@ -0,0 +1,29 @@
+/* { dg-do compile } */
+/* { dg-options "-O2 -ftree-vectorize -fdump-tree-vect-details" } */
+
+#include <stdint.h>
+
+void __attribute__ ((noinline, noclone))
+f1 (double *restrict dest, double *restrict src, int64_t *indices, int n)
+{
+#pragma GCC ivdep
+  for (int i = 0; i < n; ++i)
+    {
+      dest[indices[i * 2]] = src[i * 2] + 1;
+      dest[indices[i * 2 + 1]] = src[i * 2 + 1] + 2;
+    }
+}
+
+void __attribute__ ((noinline, noclone))
+f2 (double *restrict dest, double *restrict src, int64_t *indices, int n)
+{
+  for (int i = 0; i < n; ++i)
+    dest[indices[i]] = src[i] + 1;
+}
+
+/* The loads of the second index and source element come between the two
+   scatters of f1, which still form a single two-lane instance.  The ivdep
+   is needed because the scatters could otherwise alias across iterations.  */
+/* { dg-final { scan-tree-dump-times "LOOP VECTORIZED" 2 "vect" } } */
+/* { dg-final { scan-tree-dump {stmt 1 [^\n]*SCATTER_STORE} "vect" } } */
+/* { dg-final { scan-assembler-times {\tst1d\tz[0-9]+\.d, p[0-7], \[x[0-9]+, z[0-9]+.d, lsl 3\]\n} 2 } } */
@@ -0,0 +1,15 @@
+/* Test that -mtune-costs= overrides the vectorizer costs.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -ftree-vectorize -fvect-cost-model=dynamic -msse2 -mno-avx -fdump-tree-vect-details -mtune-costs=$srcdir/gcc.target/i386/mtune-costs-1.costs" } */
+
+float a[1024], b[1024], c[1024];
+
+void
+foo (void)
+{
+  for (int i = 0; i < 1024; i++)
+    a[i] = b[i] + c[i];
+}
+
+/* { dg-final { scan-tree-dump "vectorization not profitable" "vect" } } */
+/* { dg-final { scan-tree-dump-not "LOOP VECTORIZED" "vect" } } */
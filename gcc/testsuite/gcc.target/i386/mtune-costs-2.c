@@ -0,0 +1,10 @@
+/* Test that malformed lines of the -mtune-costs= file are diagnosed.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -mtune-costs=$srcdir/gcc.target/i386/mtune-costs-2.costs" } */
+/* { dg-error "mtune-costs-2.costs:3: invalid value .x. of cost .add." "" { target *-*-* } 0 } */
+/* { dg-error "mtune-costs-2.costs:4: invalid value .-1. of cost .lea." "" { target *-*-* } 0 } */
+/* { dg-error "mtune-costs-2.costs:5: invalid value .99999999999. of cost .fadd." "" { target *-*-* } 0 } */
+/* { dg-error "mtune-costs-2.costs:6: cost .sse_load. needs 5 values" "" { target *-*-* } 0 } */
+/* { dg-error "mtune-costs-2.costs:7: cost .mulss. needs 1 values" "" { target *-*-* } 0 } */
+
+int x;
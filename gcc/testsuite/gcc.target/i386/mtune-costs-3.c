@@ -0,0 +1,8 @@
+/* Test that unknown costs in the -mtune-costs= file are diagnosed.  */
+/* { dg-do compile } */
+/* { dg-options "-O2 -mtune-costs=$srcdir/gcc.target/i386/mtune-costs-3.costs" } */
+/* { dg-error "mtune-costs-3.costs:3: unknown cost .foo." "" { target *-*-* } 0 } */
+/* { dg-error "mtune-costs-3.costs:4: unknown cost .branch_cost." "" { target *-*-* } 0 } */
+/* { dg-error "mtune-costs-3.costs:5: unknown cost .ADD." "" { target *-*-* } 0 } */
+
+int x;
@@ -66,8 +66,12 @@ static GTY(()) tree tree_topn_values_profiler_fn;
 static GTY(()) tree tree_indirect_call_profiler_fn;
 static GTY(()) tree tree_average_profiler_fn;
 static GTY(()) tree tree_ior_profiler_fn;
+static GTY(()) tree tree_thread_counters_register_fn;
 static GTY(()) tree tree_time_profiler_counter;
 
+/* True if the value profilers update the counters atomically.  */
+static bool atomic_value_profilers;
+
 
 static GTY(()) tree ic_tuple_var;
 static GTY(()) tree ic_tuple_counters_field;
@@ -127,8 +131,7 @@ gimple_init_gcov_profiler (void)
 
   if (!gcov_type_node)
     {
-      const char *fn_suffix
-	= flag_profile_update == PROFILE_UPDATE_ATOMIC ? "_atomic" : "";
+      const char *fn_suffix = atomic_value_profilers ? "_atomic" : "";
 
       gcov_type_node = get_gcov_type ();
       gcov_type_ptr = build_pointer_type (gcov_type_node);
@@ -224,6 +227,19 @@ gimple_init_gcov_profiler (void)
 	= tree_cons (get_identifier ("leaf"), NULL,
 		     DECL_ATTRIBUTES (tree_ior_profiler_fn));
 
+      /* void (*) (gcov_type *, gcov_type *, unsigned)  */
+      tree thread_counters_register_fn_type
+	= build_function_type_list (void_type_node, gcov_type_ptr,
+				    gcov_type_ptr, unsigned_type_node,
+				    NULL_TREE);
+      tree_thread_counters_register_fn
+	= build_fn_decl ("__gcov_thread_counters_register",
+			 thread_counters_register_fn_type);
+      TREE_NOTHROW (tree_thread_counters_register_fn) = 1;
+      DECL_ATTRIBUTES (tree_thread_counters_register_fn)
+	= tree_cons (get_identifier ("leaf"), NULL,
+		     DECL_ATTRIBUTES (tree_thread_counters_register_fn));
+
       /* LTO streamer needs assembler names.  Because we create these decls
          late, we need to initialize them by hand.  */
       DECL_ASSEMBLER_NAME (tree_interval_profiler_fn);
@@ -232,6 +248,7 @@ gimple_init_gcov_profiler (void)
       DECL_ASSEMBLER_NAME (tree_indirect_call_profiler_fn);
       DECL_ASSEMBLER_NAME (tree_average_profiler_fn);
       DECL_ASSEMBLER_NAME (tree_ior_profiler_fn);
+      DECL_ASSEMBLER_NAME (tree_thread_counters_register_fn);
     }
 }
 
@@ -260,7 +277,9 @@ gimple_gen_edge_profiler (int edgeno, edge e)
     }
   else
     {
-      tree ref = tree_coverage_counter_ref (GCOV_COUNTER_ARCS, edgeno);
+      tree ref = flag_profile_update == PROFILE_UPDATE_PER_THREAD
+		 ? tree_coverage_thread_counter_ref (edgeno)
+		 : tree_coverage_counter_ref (GCOV_COUNTER_ARCS, edgeno);
       tree gcov_type_tmp_var = make_temp_ssa_name (gcov_type_node,
 						   NULL, "PROF_edge_counter");
       gassign *stmt1 = gimple_build_assign (gcov_type_tmp_var, ref);
@@ -276,6 +295,57 @@ gimple_gen_edge_profiler (int edgeno, edge e)
     }
 }
 
+/* Output instructions as GIMPLE trees at the beginning of the function
+   to register the per-thread copy of its NUM arc counters with libgcov
+   when the function is first entered by a thread.  */
+
+void
+gimple_gen_thread_counters_register (unsigned num)
+{
+  basic_block entry = ENTRY_BLOCK_PTR_FOR_FN (cfun);
+  basic_block cond_bb = split_edge (single_succ_edge (entry));
+  basic_block update_bb = split_edge (single_succ_edge (cond_bb));
+
+  /* We need to do an extra split in order to not create an input
+     for a possible PHI node.  */
+  split_edge (single_succ_edge (update_bb));
+
+  edge true_edge = single_succ_edge (cond_bb);
+  true_edge->flags = EDGE_TRUE_VALUE;
+  true_edge->probability = profile_probability::very_unlikely ();
+  edge e
+    = make_edge (cond_bb, single_succ_edge (update_bb)->dest, EDGE_FALSE_VALUE);
+  e->probability = true_edge->probability.invert ();
+
+  /* Emit: if (shadow[num] == 0).  */
+  gimple_stmt_iterator gsi = gsi_start_bb (cond_bb);
+  tree ref = force_gimple_operand_gsi (&gsi,
+				       tree_coverage_thread_counter_ref (num),
+				       true, NULL_TREE, true, GSI_SAME_STMT);
+  gcond *cond = gimple_build_cond (EQ_EXPR, ref,
+				   build_int_cst (gcov_type_node, 0),
+				   NULL, NULL);
+  gsi_insert_before (&gsi, cond, GSI_NEW_STMT);
+
+  /* Emit: __gcov_thread_counters_register (&shadow[0], &counters[0], num).  */
+  gsi = gsi_start_bb (update_bb);
+  tree shadow = force_gimple_operand_gsi (&gsi,
+					  build_fold_addr_expr
+					    (tree_coverage_thread_counter_ref
+					       (0)),
+					  true, NULL_TREE, true,
+					  GSI_SAME_STMT);
+  tree counters
+    = force_gimple_operand_gsi (&gsi,
+				tree_coverage_counter_addr (GCOV_COUNTER_ARCS,
+							    0),
+				true, NULL_TREE, true, GSI_SAME_STMT);
+  gcall *call = gimple_build_call (tree_thread_counters_register_fn, 3,
+				   shadow, counters,
+				   build_int_cst (unsigned_type_node, num));
+  gsi_insert_before (&gsi, call, GSI_SAME_STMT);
+}
+
 /* Emits code to get VALUE to instrument at GSI, and returns the
    variable containing the value.  */
 
@@ -344,16 +414,25 @@ void
 gimple_gen_topn_values_profiler (histogram_value value, unsigned tag)
 {
   gimple *stmt = value->hvalue.stmt;
-  gimple_stmt_iterator gsi = gsi_for_stmt (stmt);
+  gimple_seq seq = NULL;
+  gimple_stmt_iterator gsi;
   tree ref_ptr = tree_coverage_counter_addr (tag, 0);
   gcall *call;
   tree val;
+  edge entry = NULL;
+
+  /* Values invariant in a loop are recorded on the edge entering it.  */
+  if (value->per_loop_entry)
+    entry = gimple_loop_entry_edge (gimple_bb (stmt)->loop_father);
+  gsi = entry ? gsi_start (seq) : gsi_for_stmt (stmt);
 
   ref_ptr = force_gimple_operand_gsi (&gsi, ref_ptr,
 				      true, NULL_TREE, true, GSI_SAME_STMT);
   val = prepare_instrumented_value (&gsi, value);
   call = gimple_build_call (tree_topn_values_profiler_fn, 2, ref_ptr, val);
   gsi_insert_before (&gsi, call, GSI_NEW_STMT);
+  if (entry)
+    gsi_insert_seq_on_edge (entry, seq);
 }
 
 
@@ -517,7 +596,7 @@ gimple_gen_time_profiler (unsigned tag)
   gsi = gsi_start_bb (update_bb);
 
   /* Emit: counters[0] = ++__gcov_time_profiler_counter.  */
-  if (flag_profile_update == PROFILE_UPDATE_ATOMIC)
+  if (atomic_value_profilers)
     {
       tree ptr = make_temp_ssa_name (build_pointer_type (type), NULL,
 				     "time_profiler_counter_ptr");
@@ -718,6 +797,21 @@ tree_profiling (void)
   else if (flag_profile_update == PROFILE_UPDATE_PREFER_ATOMIC)
     flag_profile_update = can_support_atomic
       ? PROFILE_UPDATE_ATOMIC : PROFILE_UPDATE_SINGLE;
+  else if (flag_profile_update == PROFILE_UPDATE_PER_THREAD
+	   && !targetm.have_tls)
+    {
+      warning (0, "target does not support thread-local storage, "
+	       "%s mode is selected", can_support_atomic ? "atomic" : "single");
+      flag_profile_update = can_support_atomic
+	? PROFILE_UPDATE_ATOMIC : PROFILE_UPDATE_SINGLE;
+    }
+
+  /* The per-thread mode only applies to the arc counters, the value
+     profilers update the shared counters atomically when possible.  */
+  atomic_value_profilers
+    = (flag_profile_update == PROFILE_UPDATE_ATOMIC
+       || (flag_profile_update == PROFILE_UPDATE_PER_THREAD
+	   && can_support_atomic));
 
   /* This is a small-ipa pass that gets called only once, from
      cgraphunit.cc:ipa_passes().  */
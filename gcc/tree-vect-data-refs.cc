@@ -703,6 +703,11 @@ vect_slp_analyze_node_dependences (vec_info *vinfo, slp_tree node,
 	      if (! gimple_vuse (stmt))
 		continue;
 
+	      /* The stores of this instance are sunk together and keep
+		 their order in the vector stores.  */
+	      if (gimple_visited_p (stmt))
+		continue;
+
 	      /* If we couldn't record a (single) data reference for this
 		 stmt we have to resort to the alias oracle.  */
 	      stmt_vec_info stmt_info = vinfo->lookup_stmt (stmt);
@@ -848,37 +853,40 @@ vect_slp_analyze_instance_dependence (vec_info *vinfo, slp_instance instance)
   if (SLP_INSTANCE_KIND (instance) == slp_inst_kind_store)
     store = SLP_INSTANCE_TREE (instance);
 
-  /* Verify we can sink stores to the vectorized stmt insert location.  */
+  /* Mark stores in this instance and remember the last one.  The walks
+     below see the original stmts, so mark those rather than the pattern
+     stmts, such as those of scatter stores.  */
   stmt_vec_info last_store_info = NULL;
   if (store)
     {
-      if (! vect_slp_analyze_node_dependences (vinfo, store, vNULL, NULL))
-	return false;
-
-      /* Mark stores in this instance and remember the last one.  */
       last_store_info = vect_find_last_scalar_stmt_in_slp (store);
       for (unsigned k = 0; k < SLP_TREE_SCALAR_STMTS (store).length (); ++k)
-	gimple_set_visited (SLP_TREE_SCALAR_STMTS (store)[k]->stmt, true);
+	gimple_set_visited
+	  (vect_orig_stmt (SLP_TREE_SCALAR_STMTS (store)[k])->stmt, true);
     }
 
-  bool res = true;
+  /* Verify we can sink stores to the vectorized stmt insert location.  */
+  bool res = (! store
+	      || vect_slp_analyze_node_dependences (vinfo, store, vNULL, NULL));
 
   /* Verify we can sink loads to the vectorized stmt insert location,
      special-casing stores of this instance.  */
-  for (slp_tree &load : SLP_INSTANCE_LOADS (instance))
-    if (! vect_slp_analyze_node_dependences (vinfo, load,
-					     store
-					     ? SLP_TREE_SCALAR_STMTS (store)
-					     : vNULL, last_store_info))
-      {
-	res = false;
-	break;
-      }
+  if (res)
+    for (slp_tree &load : SLP_INSTANCE_LOADS (instance))
+      if (! vect_slp_analyze_node_dependences (vinfo, load,
+					       store
+					       ? SLP_TREE_SCALAR_STMTS (store)
+					       : vNULL, last_store_info))
+	{
+	  res = false;
+	  break;
+	}
 
   /* Unset the visited flag.  */
   if (store)
     for (unsigned k = 0; k < SLP_TREE_SCALAR_STMTS (store).length (); ++k)
-      gimple_set_visited (SLP_TREE_SCALAR_STMTS (store)[k]->stmt, false);
+      gimple_set_visited
+	(vect_orig_stmt (SLP_TREE_SCALAR_STMTS (store)[k])->stmt, false);
 
   return res;
 }
@@ -33,6 +33,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "ssa.h"
 #include "optabs-tree.h"
 #include "diagnostic-core.h"
+#include "alias.h"
 #include "fold-const.h"
 #include "stor-layout.h"
 #include "cfganal.h"
@@ -2484,6 +2485,7 @@ start_over:
 	     instructions record it and move on to the next instance.  */
 	  if (loads_permuted
 	      && SLP_INSTANCE_KIND (instance) == slp_inst_kind_store
+	      && STMT_VINFO_GROUPED_ACCESS (SLP_TREE_REPRESENTATIVE (slp_root))
 	      && vect_store_lanes_supported (vectype, group_size, false))
 	    {
 	      FOR_EACH_VEC_ELT (SLP_INSTANCE_LOADS (instance), i, load_node)
@@ -10331,3 +10333,385 @@ vect_rgroup_iv_might_wrap_p (loop_vec_info loop_vinfo, rgroup_controls *rgc)
 
   return false;
 }
+
+/* Return true if the exit condition COND of LOOP compares a value loaded
+   in LOOP with a loop invariant.  Store the load to *LOAD, the invariant
+   to *INV and the comparison that is true if the loop is left through
+   EXIT to *CODE.  */
+
+static bool
+vect_early_break_cond_p (class loop *loop, edge exit, gcond *cond,
+			 gassign **load, tree *inv, tree_code *code)
+{
+  tree op0 = gimple_cond_lhs (cond);
+  tree op1 = gimple_cond_rhs (cond);
+  *code = gimple_cond_code (cond);
+
+  if (TREE_CODE (op0) != SSA_NAME
+      || expr_invariant_in_loop_p (loop, op0))
+    {
+      std::swap (op0, op1);
+      *code = swap_tree_comparison (*code);
+    }
+  if (TREE_CODE (op0) != SSA_NAME
+      || !INTEGRAL_TYPE_P (TREE_TYPE (op0))
+      || !expr_invariant_in_loop_p (loop, op1))
+    return false;
+
+  gassign *def = dyn_cast <gassign *> (SSA_NAME_DEF_STMT (op0));
+  if (!def
+      || !flow_bb_inside_loop_p (loop, gimple_bb (def))
+      || !gimple_assign_load_p (def)
+      || gimple_has_volatile_ops (def))
+    return false;
+
+  if (exit->flags & EDGE_FALSE_VALUE)
+    *code = invert_tree_comparison (*code, false);
+  *load = def;
+  *inv = op1;
+  return *code != ERROR_MARK;
+}
+
+/* LOOP could not be vectorized because it has an early exit depending on
+   the data it loads, like the loops searching for an element in an array
+   or for the end of a string.  If the exit compares the elements of a
+   contiguous array with a loop invariant, teach the loop to skip a whole
+   vector of iterations at once if none of them exits:
+
+     header:
+       k = PHI <0, k'>
+       if (addr (k) % vector size == 0 && k + VF <= niters)
+	 {
+	   mask = *(vector *) addr (k) CMP invariant;
+	   if (!any (mask))
+	     {
+	       k' = k + VF;  ivs' = ivs + VF * step;
+	       goto header;
+	     }
+	 }
+       original body; k' = k + 1
+
+   The scalar body only executes the iterations of the vector which
+   contains the exit, and the iterations until the address of the
+   elements is aligned to the vector size.  Aligned vector loads never
+   cross a page boundary, so they cannot fault even though they may read
+   elements the scalar loop would not access, but the address sanitizers
+   would report those reads as overflows, so do nothing when they are
+   enabled.  Return true if LOOP was transformed.  */
+
+bool
+vect_early_break_loop (class loop *loop)
+{
+  if (loop->inner
+      || loop->simduid
+      || !loop->latch
+      || !loop_preheader_edge (loop)
+      || loop_cost_model (loop) == VECT_COST_MODEL_VERY_CHEAP
+      || (flag_sanitize & (SANITIZE_ADDRESS | SANITIZE_HWADDRESS
+			   | SANITIZE_KERNEL_ADDRESS)))
+    return false;
+
+  /* The body must be a chain of blocks ended by exit tests, without
+     side-effects and with only induction variables live across
+     iterations.  */
+  auto_vec<edge> exits = get_loop_exit_edges (loop);
+  if (exits.length () > 2)
+    return false;
+  basic_block *bbs = get_loop_body (loop);
+  bool ok = true;
+  for (unsigned i = 0; ok && i < loop->num_nodes; i++)
+    for (gimple_stmt_iterator gsi = gsi_start_bb (bbs[i]);
+	 ok && !gsi_end_p (gsi); gsi_next (&gsi))
+      {
+	gimple *stmt = gsi_stmt (gsi);
+	switch (gimple_code (stmt))
+	  {
+	  case GIMPLE_DEBUG:
+	  case GIMPLE_LABEL:
+	    break;
+	  case GIMPLE_ASSIGN:
+	    ok = (!gimple_vdef (stmt)
+		  && !gimple_has_side_effects (stmt)
+		  && !stmt_could_throw_p (cfun, stmt));
+	    break;
+	  case GIMPLE_COND:
+	    ok = loop_exit_edge_p (loop, EDGE_SUCC (bbs[i], 0))
+		 || loop_exit_edge_p (loop, EDGE_SUCC (bbs[i], 1));
+	    break;
+	  default:
+	    ok = false;
+	    break;
+	  }
+      }
+  free (bbs);
+  if (!ok)
+    return false;
+
+  auto_vec<tree, 4> steps;
+  for (gphi_iterator gsi = gsi_start_phis (loop->header);
+       !gsi_end_p (gsi); gsi_next (&gsi))
+    {
+      affine_iv iv;
+      tree res = gimple_phi_result (gsi.phi ());
+      if (virtual_operand_p (res)
+	  || !simple_iv (loop, loop, res, &iv, false)
+	  || TREE_CODE (iv.step) != INTEGER_CST)
+	return false;
+      steps.safe_push (iv.step);
+    }
+
+  /* Find the exit depending on the data and the exit counting the
+     iterations, if any.  */
+  gassign *load = NULL;
+  tree inv = NULL_TREE;
+  tree_code code = ERROR_MARK;
+  tree niters = NULL_TREE;
+  for (edge exit : exits)
+    {
+      gcond *cond = safe_dyn_cast <gcond *> (last_stmt (exit->src));
+      gassign *exit_load;
+      tree exit_inv;
+      tree_code exit_code;
+      class tree_niter_desc desc;
+
+      if (!cond)
+	return false;
+      if (!load
+	  && vect_early_break_cond_p (loop, exit, cond, &exit_load, &exit_inv,
+				      &exit_code))
+	{
+	  load = exit_load;
+	  inv = exit_inv;
+	  code = exit_code;
+	}
+      else if (!niters
+	       && number_of_iterations_exit (loop, exit, &desc, false)
+	       && integer_onep (desc.assumptions)
+	       && (TYPE_PRECISION (TREE_TYPE (desc.niter))
+		   <= TYPE_PRECISION (sizetype)))
+	niters = fold_build3 (COND_EXPR, sizetype, desc.may_be_zero,
+			      size_zero_node,
+			      fold_convert (sizetype, desc.niter));
+      else
+	return false;
+    }
+  if (!load)
+    return false;
+
+  /* The elements must be loaded from consecutive addresses.  */
+  tree ref = gimple_assign_rhs1 (load);
+  tree scalar_type = TREE_TYPE (gimple_assign_lhs (load));
+  innermost_loop_behavior drb;
+  if (!dr_analyze_innermost (&drb, ref, loop, load)
+      || TREE_CODE (drb.step) != INTEGER_CST
+      || !tree_int_cst_equal (drb.step, TYPE_SIZE_UNIT (scalar_type))
+      || !type_has_mode_precision_p (scalar_type))
+    return false;
+
+  tree vectype = get_related_vectype_for_scalar_type (VOIDmode, scalar_type);
+  unsigned HOST_WIDE_INT vf, vector_size;
+  if (!vectype
+      || !TYPE_VECTOR_SUBPARTS (vectype).is_constant (&vf)
+      || vf < 2
+      || !GET_MODE_SIZE (TYPE_MODE (vectype)).is_constant (&vector_size))
+    return false;
+  tree mask_type = truth_type_for (vectype);
+  if (!expand_vec_cmp_expr_p (vectype, mask_type, code))
+    return false;
+
+  /* Find how to test whether any element of the mask is set: with a
+     vector compare and branch, or by comparing the mask as an integer.  */
+  tree test_type = NULL_TREE;
+  machine_mode mask_mode = TYPE_MODE (mask_type);
+  if (VECTOR_MODE_P (mask_mode))
+    {
+      for (unsigned bits = 64; !test_type && bits >= BITS_PER_UNIT; bits /= 2)
+	{
+	  tree itype = build_nonstandard_integer_type (bits, 1);
+	  tree type = build_vector_type (itype,
+					 vector_size * BITS_PER_UNIT / bits);
+	  if (VECTOR_MODE_P (TYPE_MODE (type))
+	      && (optab_handler (cbranch_optab, TYPE_MODE (type))
+		  != CODE_FOR_nothing))
+	    test_type = type;
+	}
+      scalar_int_mode imode;
+      if (!test_type
+	  && int_mode_for_size (vector_size * BITS_PER_UNIT, 0).exists (&imode)
+	  && GET_MODE_BITSIZE (imode) <= 2 * BITS_PER_WORD)
+	test_type = build_nonstandard_integer_type (GET_MODE_BITSIZE (imode),
+						    1);
+    }
+  else if (SCALAR_INT_MODE_P (mask_mode)
+	   && known_eq (GET_MODE_BITSIZE (mask_mode), vf))
+    test_type = build_nonstandard_integer_type (vf, 1);
+  if (!test_type)
+    return false;
+
+  if (dump_enabled_p ())
+    dump_printf_loc (MSG_OPTIMIZED_LOCATIONS, vect_location,
+		     "early exit loop vectorized using %wu byte vectors\n",
+		     vector_size);
+
+  /* Compute the invariants in the preheader.  */
+  gimple_seq seq = NULL;
+  tree base = fold_build_pointer_plus
+		(unshare_expr (drb.base_address),
+		 size_binop (PLUS_EXPR,
+			     fold_convert (sizetype, unshare_expr (drb.offset)),
+			     fold_convert (sizetype, drb.init)));
+  base = force_gimple_operand (base, &seq, true, NULL_TREE);
+  tree vinv = gimple_build_vector_from_val
+		(&seq, vectype, gimple_convert (&seq, scalar_type, inv));
+  tree limit = NULL_TREE;
+  if (niters)
+    {
+      /* Vector iterations are allowed while K + VF <= NITERS.  */
+      gimple_seq stmts;
+      niters = force_gimple_operand (unshare_expr (niters), &stmts, true,
+				     NULL_TREE);
+      gimple_seq_add_seq (&seq, stmts);
+      tree vf_tree = size_int (vf);
+      limit = gimple_build (&seq, COND_EXPR, sizetype,
+			    gimple_build (&seq, LT_EXPR, boolean_type_node,
+					  niters, vf_tree),
+			    size_zero_node,
+			    gimple_build (&seq, PLUS_EXPR, sizetype,
+					  gimple_build (&seq, MINUS_EXPR,
+							sizetype, niters,
+							vf_tree),
+					  size_one_node));
+    }
+  gsi_insert_seq_on_edge_immediate (loop_preheader_edge (loop), seq);
+
+  /* Split the header after the PHIs and give the loop a latch on which
+     the skipping and the scalar iterations meet.  */
+  basic_block header = loop->header;
+  edge e_body = split_block_after_labels (header);
+  basic_block body = e_body->dest;
+  edge e_latch = loop_latch_edge (loop);
+  basic_block latch = split_edge (e_latch);
+  e_latch = single_pred_edge (latch);
+  loop->latch = latch;
+  basic_block vcheck = split_edge (e_body);
+
+  /* The counter of the iterations.  */
+  tree k = make_temp_ssa_name (sizetype, NULL, "ivtmp");
+  gphi *k_phi = create_phi_node (k, header);
+  add_phi_arg (k_phi, size_zero_node, loop_preheader_edge (loop),
+	       UNKNOWN_LOCATION);
+  gimple_stmt_iterator gsi = gsi_after_labels (body);
+  tree k_next = make_temp_ssa_name (sizetype, NULL, "ivtmp");
+  gsi_insert_before (&gsi, gimple_build_assign (k_next, PLUS_EXPR, k,
+						size_one_node),
+		     GSI_NEW_STMT);
+
+  /* Check whether the vector can be loaded.  */
+  seq = NULL;
+  tree addr = gimple_build (&seq, POINTER_PLUS_EXPR, TREE_TYPE (base), base,
+			    gimple_build (&seq, MULT_EXPR, sizetype, k,
+					  fold_convert (sizetype, drb.step)));
+  tree misalign
+    = gimple_build (&seq, BIT_AND_EXPR, sizetype,
+		    gimple_convert (&seq, sizetype, addr),
+		    size_int (vector_size - 1));
+  tree check = gimple_build (&seq, EQ_EXPR, boolean_type_node, misalign,
+			     size_zero_node);
+  if (limit)
+    check = gimple_build (&seq, BIT_AND_EXPR, boolean_type_node, check,
+			  gimple_build (&seq, LT_EXPR, boolean_type_node, k,
+					limit));
+  gsi = gsi_last_bb (header);
+  gsi_insert_seq_after (&gsi, seq, GSI_CONTINUE_LINKING);
+  gsi_insert_after (&gsi, gimple_build_cond (NE_EXPR, check,
+					     boolean_false_node,
+					     NULL_TREE, NULL_TREE),
+		    GSI_NEW_STMT);
+  edge e_vcheck = single_succ_edge (header);
+  e_vcheck->flags = (e_vcheck->flags & ~EDGE_FALLTHRU) | EDGE_TRUE_VALUE;
+  e_vcheck->probability = profile_probability::likely ();
+  edge e = make_edge (header, body, EDGE_FALSE_VALUE);
+  e->probability = e_vcheck->probability.invert ();
+  vcheck->count = header->count.apply_probability (e_vcheck->probability);
+
+  /* Compare the vector with the invariant and skip it if no element
+     exits.  */
+  seq = NULL;
+  tree vref = fold_build2 (MEM_REF,
+			   build_aligned_type (vectype,
+					       vector_size * BITS_PER_UNIT),
+			   addr, build_int_cst (reference_alias_ptr_type (ref),
+						0));
+  tree vec = make_ssa_name (vectype);
+  gassign *vload = gimple_build_assign (vec, vref);
+  gimple_set_vuse (vload, gimple_vuse (load));
+  gimple_seq_add_stmt (&seq, vload);
+  tree mask = make_ssa_name (mask_type);
+  gimple_seq_add_stmt (&seq, gimple_build_assign (mask, code, vec, vinv));
+  tree test = gimple_build (&seq, VIEW_CONVERT_EXPR, test_type, mask);
+  gsi = gsi_last_bb (vcheck);
+  gsi_insert_seq_after (&gsi, seq, GSI_CONTINUE_LINKING);
+  gsi_insert_after (&gsi, gimple_build_cond (NE_EXPR, test,
+					     build_zero_cst (test_type),
+					     NULL_TREE, NULL_TREE),
+		    GSI_NEW_STMT);
+  e = single_succ_edge (vcheck);
+  e->flags = (e->flags & ~EDGE_FALLTHRU) | EDGE_TRUE_VALUE;
+  e->probability = profile_probability::unlikely ();
+  edge e_skip = make_edge (vcheck, latch, EDGE_FALSE_VALUE);
+  e_skip->probability = e->probability.invert ();
+
+  /* Advance the induction variables by VF iterations on the skipping
+     edge.  */
+  gsi = gsi_last_bb (vcheck);
+  unsigned i = 0;
+  for (gphi_iterator psi = gsi_start_phis (header);
+       !gsi_end_p (psi); gsi_next (&psi))
+    {
+      gphi *phi = psi.phi ();
+      tree res = gimple_phi_result (phi);
+      tree skip;
+      seq = NULL;
+      if (phi == k_phi)
+	skip = gimple_build (&seq, PLUS_EXPR, sizetype, k, size_int (vf));
+      else
+	{
+	  tree type = TREE_TYPE (res);
+	  if (POINTER_TYPE_P (type))
+	    skip = gimple_build (&seq, POINTER_PLUS_EXPR, type, res,
+				 size_binop (MULT_EXPR,
+					     fold_convert (sizetype, steps[i]),
+					     size_int (vf)));
+	  else
+	    {
+	      tree utype = unsigned_type_for (type);
+	      tree step = fold_build2 (MULT_EXPR, utype,
+				       fold_convert (utype, steps[i]),
+				       build_int_cst (utype, vf));
+	      skip = gimple_build (&seq, PLUS_EXPR, utype,
+				   gimple_convert (&seq, utype, res), step);
+	      skip = gimple_convert (&seq, type, skip);
+	    }
+	  i++;
+	}
+      gsi_insert_seq_before (&gsi, seq, GSI_SAME_STMT);
+
+      tree next = phi == k_phi ? k_next
+		  : PHI_ARG_DEF_FROM_EDGE (phi, single_succ_edge (latch));
+      tree merged = copy_ssa_name (res);
+      gphi *latch_phi = create_phi_node (merged, latch);
+      add_phi_arg (latch_phi, next, e_latch, UNKNOWN_LOCATION);
+      add_phi_arg (latch_phi, skip, e_skip, UNKNOWN_LOCATION);
+      if (phi == k_phi)
+	add_phi_arg (phi, merged, single_succ_edge (latch), UNKNOWN_LOCATION);
+      else
+	SET_USE (PHI_ARG_DEF_PTR_FROM_EDGE (phi, single_succ_edge (latch)),
+		 merged);
+    }
+
+  set_immediate_dominator (CDI_DOMINATORS, body, header);
+  set_immediate_dominator (CDI_DOMINATORS, latch, header);
+  free_numbers_of_iterations_estimates (loop);
+  scev_reset ();
+  return true;
+}
@@ -462,6 +462,8 @@ static const int cond_expr_maps[3][5] = {
 static const int arg1_map[] = { 1, 1 };
 static const int arg2_map[] = { 1, 2 };
 static const int arg1_arg4_map[] = { 2, 1, 4 };
+static const int arg1_arg3_map[] = { 2, 1, 3 };
+static const int arg1_arg3_arg4_map[] = { 3, 1, 3, 4 };
 
 /* For most SLP statements, there is a one-to-one mapping between
    gimple arguments and child nodes.  If that is not true for STMT,
@@ -498,6 +500,12 @@ vect_get_operand_map (const gimple *stmt, unsigned char swap = 0)
 	  case IFN_MASK_GATHER_LOAD:
 	    return arg1_arg4_map;
 
+	  case IFN_SCATTER_STORE:
+	    return arg1_arg3_map;
+
+	  case IFN_MASK_SCATTER_STORE:
+	    return arg1_arg3_arg4_map;
+
 	  default:
 	    break;
 	  }
@@ -505,6 +513,58 @@ vect_get_operand_map (const gimple *stmt, unsigned char swap = 0)
   return nullptr;
 }
 
+/* Return the index of the SLP child node of STMT that holds operand OPNO.
+   For calls OPNO is the index of the call argument.  */
+
+int
+vect_slp_child_index_for_operand (const gimple *stmt, int opno)
+{
+  const int *opmap = vect_get_operand_map (stmt);
+  if (!opmap)
+    return opno;
+  for (int i = 1; i < 1 + opmap[0]; ++i)
+    if (opmap[i] == opno)
+      return i - 1;
+  gcc_unreachable ();
+}
+
+/* Return true if STMT_INFO is a scatter store.  */
+
+static bool
+vect_scatter_store_p (stmt_vec_info stmt_info)
+{
+  gcall *call = dyn_cast <gcall *> (stmt_info->stmt);
+  return (call
+	  && (gimple_call_internal_p (call, IFN_SCATTER_STORE)
+	      || gimple_call_internal_p (call, IFN_MASK_SCATTER_STORE)));
+}
+
+/* Return true if STMT_INFO is a load of consecutive elements in loop
+   vectorization that does not belong to an interleaving group.  Such
+   a load can form a single-lane SLP node of its own.  */
+
+static bool
+vect_slp_consecutive_load_p (vec_info *vinfo, stmt_vec_info stmt_info)
+{
+  loop_vec_info loop_vinfo = dyn_cast <loop_vec_info> (vinfo);
+  data_reference *dr = STMT_VINFO_DATA_REF (stmt_info);
+  if (!loop_vinfo
+      || !dr
+      || !DR_IS_READ (dr)
+      || !is_a <gassign *> (stmt_info->stmt)
+      || STMT_VINFO_GROUPED_ACCESS (stmt_info)
+      || STMT_VINFO_STRIDED_P (stmt_info)
+      || STMT_VINFO_GATHER_SCATTER_P (stmt_info)
+      || STMT_VINFO_SIMD_LANE_ACCESS_P (stmt_info)
+      || nested_in_vect_loop_p (LOOP_VINFO_LOOP (loop_vinfo), stmt_info))
+    return false;
+  tree step = DR_STEP (dr);
+  return (step
+	  && TREE_CODE (step) == INTEGER_CST
+	  && tree_int_cst_equal (step,
+				 TYPE_SIZE_UNIT (TREE_TYPE (DR_REF (dr)))));
+}
+
 /* Get the defs for the rhs of STMT (collect them in OPRNDS_INFO), check that
    they are of a valid type and that they match the defs of the first stmt of
    the SLP group (stored in OPRNDS_INFO).  This function tries to match stmts
@@ -816,8 +876,9 @@ compatible_calls_p (gcall *call1, gcall *call2)
 
   if (gimple_call_internal_p (call1))
     {
-      if (!types_compatible_p (TREE_TYPE (gimple_call_lhs (call1)),
-			       TREE_TYPE (gimple_call_lhs (call2))))
+      if (gimple_call_lhs (call1)
+	  && !types_compatible_p (TREE_TYPE (gimple_call_lhs (call1)),
+				  TREE_TYPE (gimple_call_lhs (call2))))
 	return false;
       for (unsigned int i = 0; i < nargs; ++i)
 	if (!types_compatible_p (TREE_TYPE (gimple_call_arg (call1, i)),
@@ -958,7 +1019,7 @@ vect_build_slp_tree_1 (vec_info *vinfo, unsigned char *swap,
         }
 
       lhs = gimple_get_lhs (stmt);
-      if (lhs == NULL_TREE)
+      if (lhs == NULL_TREE && !vect_scatter_store_p (stmt_info))
 	{
 	  if (dump_enabled_p ())
 	    dump_printf_loc (MSG_MISSED_OPTIMIZATION, vect_location,
@@ -1008,6 +1069,9 @@ vect_build_slp_tree_1 (vec_info *vinfo, unsigned char *swap,
 	      || cfn == CFN_GATHER_LOAD
 	      || cfn == CFN_MASK_GATHER_LOAD)
 	    load_p = true;
+	  else if (cfn == CFN_SCATTER_STORE
+		   || cfn == CFN_MASK_SCATTER_STORE)
+	    ;
 	  else if ((internal_fn_p (cfn)
 		    && !vectorizable_internal_fn_p (as_internal_fn (cfn)))
 		   || gimple_call_tail_p (call_stmt)
@@ -1242,7 +1306,9 @@ vect_build_slp_tree_1 (vec_info *vinfo, unsigned char *swap,
 	{
 	  if (load_p
 	      && rhs_code != CFN_GATHER_LOAD
-	      && rhs_code != CFN_MASK_GATHER_LOAD)
+	      && rhs_code != CFN_MASK_GATHER_LOAD
+	      && (group_size != 1
+		  || !vect_slp_consecutive_load_p (vinfo, stmt_info)))
 	    {
 	      /* Not grouped load.  */
 	      if (dump_enabled_p ())
@@ -1259,6 +1325,7 @@ vect_build_slp_tree_1 (vec_info *vinfo, unsigned char *swap,
 
 	  /* Not memory operation.  */
 	  if (!phi_p
+	      && !load_p
 	      && rhs_code.is_tree_code ()
 	      && TREE_CODE_CLASS (tree_code (rhs_code)) != tcc_binary
 	      && TREE_CODE_CLASS (tree_code (rhs_code)) != tcc_unary
@@ -1752,6 +1819,16 @@ vect_build_slp_tree_2 (vec_info *vinfo, slp_tree node,
 	  return node;
 	}
     }
+  /* A single-lane load of consecutive elements is a leaf as well.  */
+  else if (group_size == 1
+	   && vect_slp_consecutive_load_p (vinfo, stmt_info))
+    {
+      *max_nunits = this_max_nunits;
+      (*tree_size)++;
+      node = vect_create_new_slp_node (node, stmts, 0);
+      SLP_TREE_VECTYPE (node) = vectype;
+      return node;
+    }
   else if (gimple_assign_single_p (stmt_info->stmt)
 	   && !gimple_vuse (stmt_info->stmt)
 	   && gimple_assign_rhs_code (stmt_info->stmt) == BIT_FIELD_REF)
@@ -3177,7 +3254,7 @@ vect_build_slp_instance (vec_info *vinfo,
 
   stmt_vec_info stmt_info = stmt_info_;
   /* Try to break the group up into pieces.  */
-  if (kind == slp_inst_kind_store)
+  if (kind == slp_inst_kind_store && stmt_info)
     {
       /* ???  We could delay all the actual splitting of store-groups
 	 until after SLP discovery of the original group completed.
@@ -3379,6 +3456,72 @@ vect_analyze_slp_instance (vec_info *vinfo,
   return res;
 }
 
+/* Return true if the scatter stores A and B can be lanes of the same
+   SLP node, that is if they store to the same base with the same scale.  */
+
+static bool
+vect_slp_scatters_compatible_p (stmt_vec_info a, stmt_vec_info b)
+{
+  gcall *call_a = as_a <gcall *> (a->stmt);
+  gcall *call_b = as_a <gcall *> (b->stmt);
+  return (gimple_call_internal_fn (call_a) == gimple_call_internal_fn (call_b)
+	  && operand_equal_p (gimple_call_arg (call_a, 0),
+			      gimple_call_arg (call_b, 0))
+	  && operand_equal_p (gimple_call_arg (call_a, 2),
+			      gimple_call_arg (call_b, 2))
+	  && types_compatible_p (STMT_VINFO_VECTYPE (a),
+				 STMT_VINFO_VECTYPE (b)));
+}
+
+/* Analyze SLP instances for the scatter stores in SCATTERS, which are
+   compatible and in program order.  All of them are tried as a single
+   instance first, whose vector stores are emitted at the last of them.
+   If that fails, or if the scatters cannot be sunk there past the other
+   memory references in between, each of them forms a single-lane
+   instance.  */
+
+static void
+vect_analyze_slp_scatters (loop_vec_info loop_vinfo,
+			   scalar_stmts_to_slp_tree_map_t *bst_map,
+			   vec<stmt_vec_info> &scatters,
+			   unsigned max_tree_size, unsigned *limit)
+{
+  vec<stmt_vec_info> roots = vNULL;
+  vec<stmt_vec_info> scalar_stmts;
+  unsigned i;
+  stmt_vec_info stmt_info;
+
+  vect_location = scatters[0]->stmt;
+  if (scatters.length () > 1)
+    {
+      scalar_stmts = scatters.copy ();
+      if (vect_build_slp_instance (loop_vinfo, slp_inst_kind_store,
+				   scalar_stmts, roots, max_tree_size, limit,
+				   bst_map, NULL))
+	{
+	  slp_instance instance
+	    = LOOP_VINFO_SLP_INSTANCES (loop_vinfo).last ();
+	  if (vect_slp_analyze_instance_dependence (loop_vinfo, instance))
+	    return;
+	  if (dump_enabled_p ())
+	    dump_printf_loc (MSG_MISSED_OPTIMIZATION, vect_location,
+			     "cannot sink the scatter stores to the last "
+			     "one, trying single-lane instances\n");
+	  LOOP_VINFO_SLP_INSTANCES (loop_vinfo).pop ();
+	  vect_free_slp_instance (instance);
+	}
+    }
+  FOR_EACH_VEC_ELT (scatters, i, stmt_info)
+    {
+      vect_location = stmt_info->stmt;
+      scalar_stmts.create (1);
+      scalar_stmts.quick_push (stmt_info);
+      vect_build_slp_instance (loop_vinfo, slp_inst_kind_store,
+			       scalar_stmts, roots, max_tree_size, limit,
+			       bst_map, NULL);
+    }
+}
+
 /* Check if there are stmts in the loop can be vectorized using SLP.  Build SLP
    trees of packed scalar stmts if SLP is possible.  */
 
@@ -3451,6 +3594,33 @@ vect_analyze_slp (vec_info *vinfo, unsigned max_tree_size)
 	vect_analyze_slp_instance (vinfo, bst_map, loop_vinfo->reductions[0],
 				   slp_inst_kind_reduc_group, max_tree_size,
 				   &limit);
+
+      /* Find SLP sequences starting from scatter stores, grouping those
+	 with the same base and scale in program order.  Other data
+	 references may come between them, vect_analyze_slp_scatters
+	 checks that the scatters can be sunk past them.  */
+      auto_vec<vec<stmt_vec_info> > scatters;
+      data_reference_p dr;
+      FOR_EACH_VEC_ELT (LOOP_VINFO_DATAREFS (loop_vinfo), i, dr)
+	{
+	  stmt_vec_info stmt_info = loop_vinfo->lookup_dr (dr)->stmt;
+	  if (!STMT_VINFO_RELEVANT_P (stmt_info)
+	      || !vect_scatter_store_p (stmt_info))
+	    continue;
+	  unsigned j;
+	  for (j = 0; j < scatters.length (); ++j)
+	    if (vect_slp_scatters_compatible_p (scatters[j][0], stmt_info))
+	      break;
+	  if (j == scatters.length ())
+	    scatters.safe_push (vNULL);
+	  scatters[j].safe_push (stmt_info);
+	}
+      for (unsigned j = 0; j < scatters.length (); ++j)
+	{
+	  vect_analyze_slp_scatters (loop_vinfo, bst_map, scatters[j],
+				     max_tree_size, &limit);
+	  scatters[j].release ();
+	}
     }
 
   hash_set<slp_tree> visited_patterns;
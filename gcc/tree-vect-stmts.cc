@@ -2666,6 +2666,8 @@ vect_check_store_rhs (vec_info *vinfo, stmt_vec_info stmt_info,
       if (gimple_call_internal_p (call)
 	  && internal_store_fn_p (gimple_call_internal_fn (call)))
 	op_no = internal_fn_stored_value_index (gimple_call_internal_fn (call));
+      if (slp_node)
+	op_no = vect_slp_child_index_for_operand (call, op_no);
     }
 
   enum vect_def_type rhs_dt;
@@ -7428,6 +7430,10 @@ vectorizable_store (vec_info *vinfo,
   /* Is vectorizable store? */
 
   tree mask = NULL_TREE, mask_vectype = NULL_TREE;
+  slp_tree mask_node = NULL;
+  int mask_index = -1;
+  /* The index of the SLP child holding the stored value.  */
+  int value_index = 0;
   if (gassign *assign = dyn_cast <gassign *> (stmt_info->stmt))
     {
       tree scalar_dest = gimple_assign_lhs (assign);
@@ -7453,7 +7459,7 @@ vectorizable_store (vec_info *vinfo,
       if (!internal_store_fn_p (ifn))
 	return false;
 
-      if (slp_node != NULL)
+      if (slp_node != NULL && !internal_gather_scatter_fn_p (ifn))
 	{
 	  if (dump_enabled_p ())
 	    dump_printf_loc (MSG_MISSED_OPTIMIZATION, vect_location,
@@ -7461,10 +7467,19 @@ vectorizable_store (vec_info *vinfo,
 	  return false;
 	}
 
-      int mask_index = internal_fn_mask_index (ifn);
+      mask_index = internal_fn_mask_index (ifn);
+      if (slp_node)
+	{
+	  if (mask_index >= 0)
+	    mask_index = vect_slp_child_index_for_operand (call, mask_index);
+	  value_index
+	    = vect_slp_child_index_for_operand
+		(call, internal_fn_stored_value_index (ifn));
+	}
       if (mask_index >= 0
 	  && !vect_check_scalar_mask (vinfo, stmt_info, slp_node, mask_index,
-				      &mask, NULL, &mask_dt, &mask_vectype))
+				      &mask, &mask_node, &mask_dt,
+				      &mask_vectype))
 	return false;
     }
 
@@ -7586,8 +7601,11 @@ vectorizable_store (vec_info *vinfo,
 					      mask);
 
       if (slp_node
-	  && !vect_maybe_update_slp_op_vectype (SLP_TREE_CHILDREN (slp_node)[0],
-						vectype))
+	  && (!vect_maybe_update_slp_op_vectype
+		 (SLP_TREE_CHILDREN (slp_node)[value_index], vectype)
+	      || (mask
+		  && !vect_maybe_update_slp_op_vectype (mask_node,
+							mask_vectype))))
 	{
 	  if (dump_enabled_p ())
 	    dump_printf_loc (MSG_MISSED_OPTIMIZATION, vect_location,
@@ -7858,7 +7876,12 @@ vectorizable_store (vec_info *vinfo,
       ref_type = get_group_alias_ptr_type (first_stmt_info);
     }
   else
-    ref_type = reference_alias_ptr_type (DR_REF (first_dr_info->dr));
+    {
+      ref_type = reference_alias_ptr_type (DR_REF (first_dr_info->dr));
+      /* A scatter SLP node stores all its vectors at once.  */
+      if (slp)
+	vec_num = SLP_TREE_NUMBER_OF_VEC_STMTS (slp_node);
+    }
 
   if (dump_enabled_p ())
     dump_printf_loc (MSG_NOTE, vect_location,
@@ -8190,9 +8213,12 @@ vectorizable_store (vec_info *vinfo,
           if (slp)
             {
 	      /* Get vectorized arguments for SLP_NODE.  */
-	      vect_get_vec_defs (vinfo, stmt_info, slp_node, 1,
-				 op, &vec_oprnds);
+	      vect_get_slp_defs (SLP_TREE_CHILDREN (slp_node)[value_index],
+				 &vec_oprnds);
               vec_oprnd = vec_oprnds[0];
+	      if (mask)
+		vect_get_slp_defs (SLP_TREE_CHILDREN (slp_node)[mask_index],
+				   &vec_masks);
             }
           else
             {
@@ -8356,6 +8382,9 @@ vectorizable_store (vec_info *vinfo,
 	      unsigned misalign;
 	      unsigned HOST_WIDE_INT align;
 
+	      if (slp && mask)
+		vec_mask = vec_masks[i];
+
 	      tree final_mask = NULL_TREE;
 	      if (loop_masks)
 		final_mask = vect_get_loop_mask (gsi, loop_masks,
@@ -8367,6 +8396,11 @@ vectorizable_store (vec_info *vinfo,
 
 	      if (memory_access_type == VMAT_GATHER_SCATTER)
 		{
+		  if (slp)
+		    {
+		      vec_oprnd = vec_oprnds[i];
+		      vec_offset = vec_offsets[i];
+		    }
 		  tree scale = size_int (gs_info.scale);
 		  gcall *call;
 		  if (final_mask)
@@ -8380,6 +8414,8 @@ vectorizable_store (vec_info *vinfo,
 		  gimple_call_set_nothrow (call, true);
 		  vect_finish_stmt_generation (vinfo, stmt_info, call, gsi);
 		  new_stmt = call;
+		  if (slp)
+		    continue;
 		  break;
 		}
 
@@ -12388,8 +12424,10 @@ vect_get_vector_types_for_stmt (vec_info *vinfo, stmt_vec_info stmt_info,
   *nunits_vectype_out = NULL_TREE;
 
   if (gimple_get_lhs (stmt) == NULL_TREE
-      /* MASK_STORE has no lhs, but is ok.  */
-      && !gimple_call_internal_p (stmt, IFN_MASK_STORE))
+      /* MASK_STORE and scatter stores have no lhs, but are ok.  */
+      && !gimple_call_internal_p (stmt, IFN_MASK_STORE)
+      && !gimple_call_internal_p (stmt, IFN_SCATTER_STORE)
+      && !gimple_call_internal_p (stmt, IFN_MASK_SCATTER_STORE))
     {
       if (is_a <gcall *> (stmt))
 	{
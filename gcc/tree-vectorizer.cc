@@ -1066,6 +1066,18 @@ try_vectorize_loop_1 (hash_table<simduid_to_vf> *&simduid_to_vf_htab,
       if (loop_constraint_set_p (loop, LOOP_C_FINITE))
 	vect_free_loop_info_assumptions (loop);
 
+      /* Loops with an early exit depending on the loaded data cannot be
+	 vectorized as a whole, but they can skip the vectors of iterations
+	 which do not exit.  */
+      if (!loop_vectorized_call
+	  && !loop_dist_alias_call
+	  && dbg_cnt (vect_loop)
+	  && vect_early_break_loop (loop))
+	{
+	  (*num_vectorized_loops)++;
+	  return ret | TODO_cleanup_cfg;
+	}
+
       /* If we applied if-conversion then try to vectorize the
 	 BB of innermost loops.
 	 ???  Ideally BB vectorization would learn to vectorize
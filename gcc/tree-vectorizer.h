@@ -2282,6 +2282,7 @@ extern bool reduction_fn_for_scalar_code (code_helper, internal_fn *);
 
 /* Drive for loop transformation stage.  */
 extern class loop *vect_transform_loop (loop_vec_info, gimple *);
+extern bool vect_early_break_loop (class loop *);
 struct vect_loop_form_info
 {
   tree number_of_iterations;
@@ -2355,6 +2356,7 @@ extern int vect_get_place_in_interleaving_chain (stmt_vec_info, stmt_vec_info);
 extern slp_tree vect_create_new_slp_node (unsigned, tree_code);
 extern void vect_free_slp_tree (slp_tree);
 extern bool compatible_calls_p (gcall *, gcall *);
+extern int vect_slp_child_index_for_operand (const gimple *, int);
 
 /* In tree-vect-patterns.cc.  */
 extern void
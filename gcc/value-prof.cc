@@ -38,10 +38,20 @@ along with GCC; see the file COPYING3.  If not see
 #include "tree-eh.h"
 #include "gimplify.h"
 #include "gimple-iterator.h"
+#include "gimplify-me.h"
+#include "gimple-fold.h"
 #include "tree-cfg.h"
 #include "gimple-pretty-print.h"
 #include "dumpfile.h"
 #include "builtins.h"
+#include "tree-pass.h"
+#include "cfgloop.h"
+#include "tree-ssa-loop.h"
+#include "tree-ssa-loop-manip.h"
+#include "tree-ssa-propagate.h"
+#include "tree-into-ssa.h"
+#include "tree-inline.h"
+#include "ipa-utils.h"
 
 /* In this file value profile based optimizations are placed.  Currently the
    following optimizations are implemented (for more detailed descriptions
@@ -62,6 +72,13 @@ along with GCC; see the file COPYING3.  If not see
       FIXME: This transformation was removed together with RTL based value
       profiling.
 
+   4) Loop versioning.  If the bound of a loop or the step of one of its
+      induction variables is usually the same value, the loop is versioned
+      for that value, so the copy has a constant trip count or stride and
+      can be fully unrolled or vectorized without an epilogue.  These
+      values are invariant in the loop and are profiled only once per
+      entry into it.
+
 
    Value profiling internals
    ==========================
@@ -106,6 +123,7 @@ static bool gimple_divmod_fixed_value_transform (gimple_stmt_iterator *);
 static bool gimple_mod_pow2_value_transform (gimple_stmt_iterator *);
 static bool gimple_mod_subtract_transform (gimple_stmt_iterator *);
 static bool gimple_stringops_transform (gimple_stmt_iterator *);
+static bool gimple_version_loops_for_values (void);
 static void dump_ic_profile (gimple_stmt_iterator *gsi);
 
 /* Allocate histogram value.  */
@@ -658,6 +676,9 @@ gimple_value_profile_transformations (void)
         }
     }
 
+  if (gimple_version_loops_for_values ())
+    changed = true;
+
   return changed;
 }
 
@@ -1300,12 +1321,94 @@ find_func_by_profile_id (int profile_id)
     return NULL;
 }
 
+/* Return the value of the virtual table pointer of the object ICALL_STMT
+   is invoked on which implies the call goes to DIRECT_CALL and store the
+   virtual table pointer to *VPTR, or return NULL_TREE if there is no such
+   value.
+
+   This is the case when DIRECT_CALL is a method of a final class and the
+   primary virtual table of the class holds it in the slot ICALL_STMT loads
+   the function address from.  Objects of other classes never point to that
+   virtual table, so comparing the virtual table pointer misses no call to
+   DIRECT_CALL, and it leaves the load of the function address to the
+   indirect call.  */
+
+static tree
+gimple_ic_vtable_guard (gcall *icall_stmt, cgraph_node *direct_call,
+			tree *vptr)
+{
+  tree fn = gimple_call_fn (icall_stmt);
+  if (!flag_devirtualize || !virtual_method_call_p (fn))
+    return NULL_TREE;
+
+  tree decl = direct_call->ultimate_alias_target ()->decl;
+  if (TREE_CODE (TREE_TYPE (decl)) != METHOD_TYPE || !DECL_VIRTUAL_P (decl))
+    return NULL_TREE;
+  tree type = TYPE_METHOD_BASETYPE (TREE_TYPE (decl));
+  if (!TYPE_FINAL_P (type)
+      || !TYPE_BINFO (type)
+      || !BINFO_VTABLE (TYPE_BINFO (type)))
+    return NULL_TREE;
+
+  tree vtable;
+  unsigned HOST_WIDE_INT offset;
+  if (!vtable_pointer_value_to_vtable (BINFO_VTABLE (TYPE_BINFO (type)),
+				       &vtable, &offset)
+      || !VAR_P (vtable))
+    return NULL_TREE;
+
+  /* We are going to introduce a new reference to the virtual table.  */
+  if (!can_refer_decl_in_current_unit_p (vtable, NULL_TREE))
+    return NULL_TREE;
+
+  HOST_WIDE_INT token = tree_to_shwi (OBJ_TYPE_REF_TOKEN (fn));
+  tree target = gimple_get_virt_method_for_vtable (token, vtable, offset,
+						   NULL);
+  cgraph_node *target_node = target ? cgraph_node::get (target) : NULL;
+  if (!target_node || target_node->ultimate_alias_target ()->decl != decl)
+    return NULL_TREE;
+
+  /* Match the load of the function address from the slot TOKEN:
+       _1 = vptr + OFF1;
+       fn = MEM[_1 + OFF2];  */
+  tree addr = OBJ_TYPE_REF_EXPR (fn);
+  if (TREE_CODE (addr) != SSA_NAME)
+    return NULL_TREE;
+  gimple *def = SSA_NAME_DEF_STMT (addr);
+  if (!gimple_assign_load_p (def)
+      || TREE_CODE (gimple_assign_rhs1 (def)) != MEM_REF
+      || TREE_THIS_VOLATILE (gimple_assign_rhs1 (def)))
+    return NULL_TREE;
+  tree base = TREE_OPERAND (gimple_assign_rhs1 (def), 0);
+  poly_offset_int off = mem_ref_offset (gimple_assign_rhs1 (def));
+  if (TREE_CODE (base) != SSA_NAME)
+    return NULL_TREE;
+  def = SSA_NAME_DEF_STMT (base);
+  if (is_gimple_assign (def)
+      && gimple_assign_rhs_code (def) == POINTER_PLUS_EXPR
+      && TREE_CODE (gimple_assign_rhs1 (def)) == SSA_NAME
+      && TREE_CODE (gimple_assign_rhs2 (def)) == INTEGER_CST)
+    {
+      off += wi::to_offset (gimple_assign_rhs2 (def));
+      base = gimple_assign_rhs1 (def);
+    }
+  if (maybe_ne (off,
+		token * wi::to_offset (TYPE_SIZE_UNIT (TREE_TYPE (addr)))))
+    return NULL_TREE;
+
+  *vptr = base;
+  return fold_build_pointer_plus_hwi (build_fold_addr_expr (vtable), offset);
+}
+
 /* Do transformation
 
   if (actual_callee_address == address_of_most_common_function/method)
     do direct call
   else
     old call
+
+  For virtual calls the virtual table pointer is compared instead of the
+  function address when that is possible, see gimple_ic_vtable_guard.
  */
 
 gcall *
@@ -1326,13 +1429,17 @@ gimple_ic (gcall *icall_stmt, struct cgraph_node *direct_call,
   cond_bb = gimple_bb (icall_stmt);
   gsi = gsi_for_stmt (icall_stmt);
 
+  tree vptr = NULL_TREE;
+  tree vtable_ptr = gimple_ic_vtable_guard (icall_stmt, direct_call, &vptr);
+
   tmp0 = make_temp_ssa_name (ptr_type_node, NULL, "PROF");
   tmp1 = make_temp_ssa_name (ptr_type_node, NULL, "PROF");
-  tmp = unshare_expr (gimple_call_fn (icall_stmt));
+  tmp = vtable_ptr ? vptr : unshare_expr (gimple_call_fn (icall_stmt));
   load_stmt = gimple_build_assign (tmp0, tmp);
   gsi_insert_before (&gsi, load_stmt, GSI_SAME_STMT);
 
-  tmp = fold_convert (ptr_type_node, build_addr (direct_call->decl));
+  tmp = fold_convert (ptr_type_node,
+		      vtable_ptr ? vtable_ptr : build_addr (direct_call->decl));
   load_stmt = gimple_build_assign (tmp1, tmp);
   gsi_insert_before (&gsi, load_stmt, GSI_SAME_STMT);
 
@@ -1729,6 +1836,348 @@ gimple_stringops_transform (gimple_stmt_iterator *gsi)
   return true;
 }
 
+/* Return the single edge entering LOOP from outside of it, or NULL if
+   there is no such edge.  */
+
+edge
+gimple_loop_entry_edge (class loop *loop)
+{
+  edge e, entry = NULL;
+  edge_iterator ei;
+
+  FOR_EACH_EDGE (e, ei, loop->header->preds)
+    if (!flow_bb_inside_loop_p (loop, e->src))
+      {
+	if (entry || (e->flags & EDGE_COMPLEX))
+	  return NULL;
+	entry = e;
+      }
+  return entry;
+}
+
+/* Return true if NAME is an SSA name defined outside of LOOP.  */
+
+static bool
+loop_invariant_name_p (class loop *loop, tree name)
+{
+  if (TREE_CODE (name) != SSA_NAME)
+    return false;
+  if (SSA_NAME_IS_DEFAULT_DEF (name))
+    return true;
+  basic_block bb = gimple_bb (SSA_NAME_DEF_STMT (name));
+  return bb && !flow_bb_inside_loop_p (loop, bb);
+}
+
+/* If the exit condition of LOOP compares an induction variable with a
+   value invariant in LOOP, return the condition and set *BOUND to the
+   value.  */
+
+static gcond *
+loop_bound_to_profile (class loop *loop, tree *bound)
+{
+  auto_vec<edge> exits = get_loop_exit_edges (loop);
+  if (exits.length () != 1)
+    return NULL;
+  gcond *cond = safe_dyn_cast <gcond *> (last_stmt (exits[0]->src));
+  if (!cond)
+    return NULL;
+  tree lhs = gimple_cond_lhs (cond);
+  tree rhs = gimple_cond_rhs (cond);
+  if (!INTEGRAL_TYPE_P (TREE_TYPE (lhs)))
+    return NULL;
+  if (loop_invariant_name_p (loop, rhs) && TREE_CODE (lhs) == SSA_NAME
+      && !loop_invariant_name_p (loop, lhs))
+    *bound = rhs;
+  else if (loop_invariant_name_p (loop, lhs) && TREE_CODE (rhs) == SSA_NAME
+	   && !loop_invariant_name_p (loop, rhs))
+    *bound = lhs;
+  else
+    return NULL;
+  return cond;
+}
+
+/* Return the integer value invariant in LOOP from which OP is computed
+   in LOOP by conversions and by multiplications or shifts by constants,
+   or NULL_TREE.  Profiling runs before invariant motion, so the step of
+   a pointer induction variable is typically still scaled by the element
+   size inside the loop body.  */
+
+static tree
+loop_invariant_step_base (class loop *loop, tree op)
+{
+  for (unsigned depth = 0; depth < 4; depth++)
+    {
+      if (loop_invariant_name_p (loop, op))
+	return INTEGRAL_TYPE_P (TREE_TYPE (op)) ? op : NULL_TREE;
+      if (TREE_CODE (op) != SSA_NAME)
+	return NULL_TREE;
+      gassign *def = dyn_cast <gassign *> (SSA_NAME_DEF_STMT (op));
+      if (!def)
+	return NULL_TREE;
+      switch (gimple_assign_rhs_code (def))
+	{
+	CASE_CONVERT:
+	  if (!INTEGRAL_TYPE_P (TREE_TYPE (gimple_assign_rhs1 (def))))
+	    return NULL_TREE;
+	  break;
+	case MULT_EXPR:
+	case LSHIFT_EXPR:
+	  if (TREE_CODE (gimple_assign_rhs2 (def)) != INTEGER_CST)
+	    return NULL_TREE;
+	  break;
+	default:
+	  return NULL_TREE;
+	}
+      op = gimple_assign_rhs1 (def);
+    }
+  return NULL_TREE;
+}
+
+/* If STMT increments the result of header PHI of LOOP by a value computed
+   from a value invariant in LOOP, return the statement and set *STEP to
+   the invariant value.  */
+
+static gassign *
+loop_step_to_profile (class loop *loop, gphi *phi, tree *step)
+{
+  tree res = gimple_phi_result (phi);
+  if (virtual_operand_p (res)
+      || (!INTEGRAL_TYPE_P (TREE_TYPE (res))
+	  && !POINTER_TYPE_P (TREE_TYPE (res))))
+    return NULL;
+  tree next = PHI_ARG_DEF_FROM_EDGE (phi, loop_latch_edge (loop));
+  if (TREE_CODE (next) != SSA_NAME)
+    return NULL;
+  gassign *stmt = dyn_cast <gassign *> (SSA_NAME_DEF_STMT (next));
+  if (!stmt
+      || !flow_bb_inside_loop_p (loop, gimple_bb (stmt))
+      || (gimple_assign_rhs_code (stmt) != PLUS_EXPR
+	  && gimple_assign_rhs_code (stmt) != POINTER_PLUS_EXPR)
+      || gimple_assign_rhs1 (stmt) != res)
+    return NULL;
+  *step = loop_invariant_step_base (loop, gimple_assign_rhs2 (stmt));
+  return *step ? stmt : NULL;
+}
+
+/* Return the statements of LOOP whose histograms drive its versioning for
+   values: the exit condition and the increments of induction variables.  */
+
+static auto_vec<gimple *, 4>
+loop_value_stmts (class loop *loop)
+{
+  auto_vec<gimple *, 4> stmts;
+  tree value;
+
+  if (gcond *cond = loop_bound_to_profile (loop, &value))
+    stmts.safe_push (cond);
+  for (gphi_iterator gsi = gsi_start_phis (loop->header);
+       !gsi_end_p (gsi); gsi_next (&gsi))
+    if (gassign *stmt = loop_step_to_profile (loop, gsi.phi (), &value))
+      stmts.safe_push (stmt);
+  return stmts;
+}
+
+/* Return the histogram of value invariant in the loop containing STMT
+   attached to STMT, if any.  */
+
+static histogram_value
+loop_value_histogram (gimple *stmt)
+{
+  histogram_value hist
+    = gimple_histogram_value_of_type (cfun, stmt, HIST_TYPE_TOPN_VALUES);
+  return hist && hist->per_loop_entry ? hist : NULL;
+}
+
+/* Do transform 4) on LOOP if applicable: version it for the common values
+   of its bound and steps.  Return the copy used for the common values and
+   push the values and the constants to substitute for them in the copy to
+   VALUES, or return NULL.  */
+
+static class loop *
+gimple_version_loop_for_values (class loop *loop,
+				vec<std::pair<tree, tree> > *values)
+{
+  profile_probability prob = profile_probability::always ();
+  tree cond = boolean_false_node;
+  unsigned first = values->length ();
+  gimple *stmt;
+  unsigned i;
+
+  auto_vec<gimple *, 4> stmts = loop_value_stmts (loop);
+  FOR_EACH_VEC_ELT (stmts, i, stmt)
+    {
+      histogram_value hist = loop_value_histogram (stmt);
+      if (!hist)
+	continue;
+
+      tree name = hist->hvalue.value;
+      gcov_type val, count, all;
+      bool found = get_nth_most_common_value (NULL, "loop", hist, &val,
+					      &count, &all);
+      gimple_remove_histogram_value (cfun, stmt, hist);
+
+      /* We require that count is at least three quarters of all.  */
+      if (!found || all <= 0 || 4 * count < 3 * all)
+	continue;
+      bool seen = false;
+      for (unsigned j = first; j < values->length (); j++)
+	if ((*values)[j].first == name)
+	  seen = true;
+      if (seen)
+	continue;
+
+      tree cst = build_int_cst (TREE_TYPE (name), val);
+      cond = fold_build2 (TRUTH_OR_EXPR, boolean_type_node, cond,
+			  fold_build2 (NE_EXPR, boolean_type_node, name, cst));
+      profile_probability p
+	= profile_probability::probability_in_gcov_type (count, all);
+      if (p < prob)
+	prob = p;
+      values->safe_push (std::make_pair (name, cst));
+    }
+
+  if (values->length () == first)
+    return NULL;
+
+  if (!optimize_loop_for_speed_p (loop)
+      || !can_duplicate_loop_p (loop)
+      || (tree_num_loop_insns (loop, &eni_size_weights)
+	  > (unsigned) param_loop_versioning_max_inner_insns))
+    {
+      values->truncate (first);
+      return NULL;
+    }
+
+  gimple_seq seq = NULL;
+  cond = force_gimple_operand_1 (cond, &seq, is_gimple_condexpr, NULL_TREE);
+
+  initialize_original_copy_tables ();
+  basic_block cond_bb;
+  class loop *nloop = loop_version (loop, cond, &cond_bb, prob.invert (),
+				    prob, prob.invert (), prob, true);
+  free_original_copy_tables ();
+  if (!nloop)
+    {
+      values->truncate (first);
+      return NULL;
+    }
+
+  if (seq)
+    {
+      gimple_stmt_iterator gsi = gsi_last_bb (cond_bb);
+      gsi_insert_seq_before (&gsi, seq, GSI_SAME_STMT);
+    }
+
+  if (dump_enabled_p ())
+    for (i = first; i < values->length (); i++)
+      dump_printf_loc (MSG_OPTIMIZED_LOCATIONS, get_loop_location (loop),
+		       "Transformation done: versioned loop for %T == %T\n",
+		       (*values)[i].first, (*values)[i].second);
+  return nloop;
+}
+
+/* Replace the uses of the values in elements FIRST to END - 1 of VALUES
+   in LOOP by the constants they are paired with.  */
+
+static void
+substitute_loop_values (class loop *loop,
+			const vec<std::pair<tree, tree> > &values,
+			unsigned first, unsigned end)
+{
+  basic_block *bbs = get_loop_body (loop);
+
+  for (unsigned i = 0; i < loop->num_nodes; i++)
+    {
+      use_operand_p use_p;
+      ssa_op_iter iter;
+
+      for (gphi_iterator gsi = gsi_start_phis (bbs[i]);
+	   !gsi_end_p (gsi); gsi_next (&gsi))
+	FOR_EACH_PHI_ARG (use_p, gsi.phi (), iter, SSA_OP_USE)
+	  for (unsigned j = first; j < end; j++)
+	    if (USE_FROM_PTR (use_p) == values[j].first)
+	      SET_USE (use_p, values[j].second);
+
+      for (gimple_stmt_iterator gsi = gsi_start_bb (bbs[i]);
+	   !gsi_end_p (gsi); gsi_next (&gsi))
+	{
+	  bool changed = false;
+	  FOR_EACH_SSA_USE_OPERAND (use_p, gsi_stmt (gsi), iter, SSA_OP_USE)
+	    for (unsigned j = first; j < end; j++)
+	      if (USE_FROM_PTR (use_p) == values[j].first)
+		{
+		  propagate_value (use_p, values[j].second);
+		  changed = true;
+		  break;
+		}
+	  if (changed)
+	    {
+	      fold_stmt (&gsi);
+	      update_stmt (gsi_stmt (gsi));
+	    }
+	}
+    }
+  free (bbs);
+}
+
+/* Version the innermost loops of the current function for the common
+   values of their bounds and steps.  Return true if some loop was
+   versioned.  */
+
+static bool
+gimple_version_loops_for_values (void)
+{
+  if (!current_loops || loops_state_satisfies_p (LOOPS_NEED_FIXUP))
+    return false;
+
+  /* Look for the histograms first, so the loop optimizer is initialized
+     only when needed.  */
+  auto_vec<class loop *> loops;
+  for (auto loop : loops_list (cfun, LI_ONLY_INNERMOST))
+    if (loop->latch && gimple_loop_entry_edge (loop))
+      {
+	auto_vec<gimple *, 4> stmts = loop_value_stmts (loop);
+	gimple *stmt;
+	unsigned i;
+	FOR_EACH_VEC_ELT (stmts, i, stmt)
+	  if (loop_value_histogram (stmt))
+	    {
+	      loops.safe_push (loop);
+	      break;
+	    }
+      }
+  if (loops.is_empty ())
+    return false;
+
+  loop_optimizer_init (LOOPS_NORMAL);
+
+  auto_vec<std::pair<tree, tree> > values;
+  auto_vec<std::pair<class loop *, unsigned> > versions;
+  class loop *loop;
+  unsigned i;
+  FOR_EACH_VEC_ELT (loops, i, loop)
+    {
+      unsigned first = values.length ();
+      if (class loop *nloop = gimple_version_loop_for_values (loop, &values))
+	versions.safe_push (std::make_pair (nloop, first));
+    }
+
+  if (!versions.is_empty ())
+    {
+      update_ssa (TODO_update_ssa);
+      for (i = 0; i < versions.length (); i++)
+	{
+	  unsigned end = (i + 1 < versions.length ()
+			  ? versions[i + 1].second : values.length ());
+	  substitute_loop_values (versions[i].first, values,
+				  versions[i].second, end);
+	}
+    }
+
+  loop_optimizer_finalize ();
+  return !versions.is_empty ();
+}
+
 void
 stringop_block_profile (gimple *stmt, unsigned int *expected_align,
 			HOST_WIDE_INT *expected_size)
@@ -1897,6 +2346,50 @@ gimple_stringops_values_to_profile (gimple *gs, histogram_values *values)
 						     stmt, dest));
 }
 
+/* Find the bounds and the steps of induction variables of innermost loops
+   for that we want to measure histograms for loop versioning and add
+   them to list VALUES.  */
+
+static void
+gimple_loop_values_to_profile (histogram_values *values)
+{
+  if (!current_loops || loops_state_satisfies_p (LOOPS_NEED_FIXUP))
+    return;
+
+  for (auto loop : loops_list (cfun, LI_ONLY_INNERMOST))
+    {
+      if (!loop->latch || !gimple_loop_entry_edge (loop))
+	continue;
+
+      tree value;
+      if (gcond *cond = loop_bound_to_profile (loop, &value))
+	{
+	  histogram_value hist
+	    = gimple_alloc_histogram_value (cfun, HIST_TYPE_TOPN_VALUES,
+					    cond, value);
+	  hist->per_loop_entry = true;
+	  values->safe_push (hist);
+	}
+
+      /* Induction variables stepping through arrays of the same type
+	 share the step, profile it once.  */
+      auto_vec<tree, 4> steps;
+      for (gphi_iterator gsi = gsi_start_phis (loop->header);
+	   !gsi_end_p (gsi); gsi_next (&gsi))
+	if (gassign *stmt = loop_step_to_profile (loop, gsi.phi (), &value))
+	  {
+	    if (steps.contains (value))
+	      continue;
+	    steps.safe_push (value);
+	    histogram_value hist
+	      = gimple_alloc_histogram_value (cfun, HIST_TYPE_TOPN_VALUES,
+					      stmt, value);
+	    hist->per_loop_entry = true;
+	    values->safe_push (hist);
+	  }
+    }
+}
+
 /* Find values inside STMT for that we want to measure histograms and adds
    them to list VALUES.  */
 
@@ -1921,6 +2414,8 @@ gimple_find_values_to_profile (histogram_values *values)
     for (gsi = gsi_start_bb (bb); !gsi_end_p (gsi); gsi_next (&gsi))
       gimple_values_to_profile (gsi_stmt (gsi), values);
 
+  gimple_loop_values_to_profile (values);
+
   values->safe_push (gimple_alloc_histogram_value (cfun,
 						   HIST_TYPE_TIME_PROFILE));
 
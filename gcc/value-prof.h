@@ -52,6 +52,9 @@ struct histogram_value_t
     } hvalue;
   enum hist_type type;			/* Type of information to measure.  */
   unsigned n_counters;			/* Number of required counters.  */
+  /* Set if the value is invariant in the loop containing the statement
+     and is profiled only once per entry into the loop.  */
+  bool per_loop_entry;
   struct function *fun;
   union
     {
@@ -88,6 +91,7 @@ void gimple_move_stmt_histograms (struct function *, gimple *, gimple *);
 void verify_histograms (void);
 void free_histograms (function *);
 void stringop_block_profile (gimple *, unsigned int *, HOST_WIDE_INT *);
+edge gimple_loop_entry_edge (class loop *);
 gcall *gimple_ic (gcall *, struct cgraph_node *, profile_probability);
 bool get_nth_most_common_value (gimple *stmt, const char *counter_type,
 				histogram_value hist, gcov_type *value,
@@ -97,6 +101,7 @@ bool get_nth_most_common_value (gimple *stmt, const char *counter_type,
 /* In tree-profile.cc.  */
 extern void gimple_init_gcov_profiler (void);
 extern void gimple_gen_edge_profiler (int, edge);
+extern void gimple_gen_thread_counters_register (unsigned);
 extern void gimple_gen_interval_profiler (histogram_value, unsigned);
 extern void gimple_gen_pow2_profiler (histogram_value, unsigned);
 extern void gimple_gen_topn_values_profiler (histogram_value, unsigned);
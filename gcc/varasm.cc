@@ -629,6 +629,19 @@ default_function_section (tree decl, enum node_frequency freq,
   if (exit && freq != NODE_FREQUENCY_UNLIKELY_EXECUTED)
     return get_named_text_section (decl, ".text.exit", NULL);
 
+  /* Functions placed by the call-chain clustering are put into sections
+     sorted by name by the linker.  */
+  if (decl && freq != NODE_FREQUENCY_UNLIKELY_EXECUTED)
+    {
+      cgraph_node *node = cgraph_node::get (decl);
+      if (node && node->layout_order)
+	{
+	  char name[32];
+	  sprintf (name, ".text.sorted.%010d", node->layout_order);
+	  return get_named_text_section (decl, name, NULL);
+	}
+    }
+
   /* Group cold functions together, similarly for hot code.  */
   switch (freq)
     {
@@ -109,6 +109,9 @@ struct _cpp_file
   /* If this file is implicitly preincluded.  */
   bool implicit_preinclude : 1;
 
+  /* If this file was made a dependency without being stacked.  */
+  bool skipped_dep : 1;
+
   /* > 0: Known C++ Module header unit, <0: known not.  ==0, unknown  */
   int header_unit : 2;
 };
@@ -191,6 +194,8 @@ static struct cpp_file_hash_entry *new_file_hash_entry (cpp_reader *pfile);
 static int report_missing_guard (void **slot, void *b);
 static hashval_t file_hash_hash (const void *p);
 static int file_hash_eq (const void *p, const void *q);
+static hashval_t guarded_file_hash_hash (const void *p);
+static int guarded_file_hash_eq (const void *p, const void *q);
 static char *read_filename_string (int ch, FILE *f);
 static void read_name_map (cpp_dir *dir);
 static char *remap_filename (cpp_reader *pfile, _cpp_file *file);
@@ -785,6 +790,59 @@ read_file (cpp_reader *pfile, _cpp_file *file, location_t loc)
   return !file->dont_read;
 }
 
+/* FILE has not been stacked before.  If we have already processed the
+   same file under a different name, and found it to have a controlling
+   macro, return that macro.  This allows a header reached through
+   several spellings to be skipped without reading it again.  Return
+   NULL otherwise.  */
+static const cpp_hashnode *
+guard_of_same_file (cpp_reader *pfile, _cpp_file *file)
+{
+  /* Inode numbers are not meaningful on all hosts.  */
+  if (file->err_no || !file->st.st_ino)
+    return NULL;
+
+  _cpp_file *f = (_cpp_file *) htab_find (pfile->guarded_file_hash, file);
+  if (f
+      && f != file
+      && f->st.st_mtime == file->st.st_mtime
+      && f->st.st_size == file->st.st_size)
+    return f->cmacro;
+
+  return NULL;
+}
+
+/* FILE has just been found to have a controlling macro.  Remember it
+   for guard_of_same_file.  */
+static void
+record_guarded_file (cpp_reader *pfile, _cpp_file *file)
+{
+  if (file->err_no || !file->st.st_ino)
+    return;
+
+  /* A later file with the same inode replaces an earlier one, which
+     must have been modified or replaced in the meantime.  */
+  void **slot = htab_find_slot (pfile->guarded_file_hash, file, INSERT);
+  *slot = file;
+}
+
+/* Add FILE, about to be included from the current buffer, to the
+   dependencies if they are wanted for it.  */
+static void
+add_file_to_deps (cpp_reader *pfile, _cpp_file *file)
+{
+  int sysp = 0;
+
+  if (pfile->buffer && file->dir)
+    sysp = MAX (pfile->buffer->sysp, file->dir->sysp);
+
+  if (CPP_OPTION (pfile, deps.style) > (sysp != 0)
+      && file->path[0]
+      && !(pfile->main_file == file
+	   && CPP_OPTION (pfile, deps.ignore_main_file)))
+    deps_add_dep (pfile->deps, file->path);
+}
+
 /* Returns TRUE if FILE is already known to be idempotent, and should
    therefore not be read again.  */
 static bool
@@ -806,10 +864,34 @@ is_known_idempotent_file (cpp_reader *pfile, _cpp_file *file, bool import)
 	return true;
     }
 
+  /* If we've not seen this name before, we may still have seen the
+     file, and know its header guard.  */
+  bool same_file = false;
+  if (!file->cmacro && !file->stack_count && !file->pchname)
+    {
+      file->cmacro = guard_of_same_file (pfile, file);
+      same_file = file->cmacro != NULL;
+    }
+
   /* Skip if the file had a header guard and the macro is defined.
      PCH relies on this appearing before the PCH handler below.  */
   if (file->cmacro && cpp_macro_p (file->cmacro))
-    return true;
+    {
+      /* We may have just opened it.  */
+      if (file->fd != -1)
+	{
+	  close (file->fd);
+	  file->fd = -1;
+	}
+      /* Reading it would have made this name a dependency, so make it
+	 one anyway.  */
+      if (same_file)
+	{
+	  add_file_to_deps (pfile, file);
+	  file->skipped_dep = true;
+	}
+      return true;
+    }
 
   /* Handle PCH files immediately; don't stack them.  */
   if (file->pchname)
@@ -954,12 +1036,8 @@ _cpp_stack_file (cpp_reader *pfile, _cpp_file *file, include_type type,
 	sysp = MAX (pfile->buffer->sysp, file->dir->sysp);
 
       /* Add the file to the dependencies on its first inclusion.  */
-      if (CPP_OPTION (pfile, deps.style) > (sysp != 0)
-	  && !file->stack_count
-	  && file->path[0]
-	  && !(pfile->main_file == file
-	       && CPP_OPTION (pfile, deps.ignore_main_file)))
-	deps_add_dep (pfile->deps, file->path);
+      if (!file->stack_count && !file->skipped_dep)
+	add_file_to_deps (pfile, file);
 
       /* Clear buffer_valid since _cpp_clean_line messes it up.  */
       file->buffer_valid = false;
@@ -1434,6 +1512,25 @@ nonexistent_file_hash_eq (const void *p, const void *q)
   return filename_cmp ((const char *) p, (const char *) q) == 0;
 }
 
+/* Hash function for the guarded file hash table, keyed by the device
+   and inode of a _cpp_file.  */
+static hashval_t
+guarded_file_hash_hash (const void *p)
+{
+  const _cpp_file *file = (const _cpp_file *) p;
+  hashval_t h = iterative_hash (&file->st.st_ino, sizeof (file->st.st_ino), 0);
+  return iterative_hash (&file->st.st_dev, sizeof (file->st.st_dev), h);
+}
+
+/* Compare two _cpp_files by device and inode.  */
+static int
+guarded_file_hash_eq (const void *p, const void *q)
+{
+  const _cpp_file *f1 = (const _cpp_file *) p;
+  const _cpp_file *f2 = (const _cpp_file *) q;
+  return f1->st.st_ino == f2->st.st_ino && f1->st.st_dev == f2->st.st_dev;
+}
+
 /* Initialize everything in this source file.  */
 void
 _cpp_init_files (cpp_reader *pfile)
@@ -1443,6 +1540,9 @@ _cpp_init_files (cpp_reader *pfile)
   pfile->dir_hash = htab_create_alloc (127, file_hash_hash, file_hash_eq,
 					NULL, xcalloc, free);
   allocate_file_hash_entries (pfile);
+  pfile->guarded_file_hash = htab_create_alloc (127, guarded_file_hash_hash,
+						guarded_file_hash_eq,
+						NULL, xcalloc, free);
   pfile->nonexistent_file_hash = htab_create_alloc (127, htab_hash_string,
 						    nonexistent_file_hash_eq,
 						    NULL, xcalloc, free);
@@ -1456,6 +1556,7 @@ _cpp_cleanup_files (cpp_reader *pfile)
 {
   htab_delete (pfile->file_hash);
   htab_delete (pfile->dir_hash);
+  htab_delete (pfile->guarded_file_hash);
   htab_delete (pfile->nonexistent_file_hash);
   obstack_free (&pfile->nonexistent_file_ob, 0);
   free_file_hash_entries (pfile);
@@ -1641,7 +1742,11 @@ _cpp_pop_file_buffer (cpp_reader *pfile, _cpp_file *file,
   /* Record the inclusion-preventing macro, which could be NULL
      meaning no controlling macro.  */
   if (pfile->mi_valid && file->cmacro == NULL)
-    file->cmacro = pfile->mi_cmacro;
+    {
+      file->cmacro = pfile->mi_cmacro;
+      if (file->cmacro)
+	record_guarded_file (pfile, file);
+    }
 
   /* Invalidate control macros in the #including file.  */
   pfile->mi_valid = false;
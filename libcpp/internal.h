@@ -473,6 +473,9 @@ struct cpp_reader
   struct htab *dir_hash;
   struct file_hash_entry_pool *file_hash_entries;
 
+  /* Files with a controlling macro, hashed by device and inode.  */
+  struct htab *guarded_file_hash;
+
   /* Negative path lookup hash table.  */
   struct htab *nonexistent_file_hash;
   struct obstack nonexistent_file_ob;
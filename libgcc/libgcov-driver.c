@@ -701,6 +701,9 @@ __gcov_dump_one (struct gcov_root *root)
   if (root->dumped)
     return;
 
+  if (__gcov_thread_counters_flush)
+    __gcov_thread_counters_flush ();
+
   gcov_do_dump (root->list, root->run_counted);
   
   root->dumped = 1;
@@ -714,6 +717,10 @@ struct gcov_root __gcov_root;
 struct gcov_master __gcov_master = 
   {GCOV_VERSION, 0};
 
+/* Set once per-thread copies of arc counters are registered.  */
+void (*__gcov_thread_counters_flush) (void);
+void (*__gcov_thread_counters_release) (void);
+
 /* Dynamic pool for gcov_kvp structures.  */
 struct gcov_kvp *__gcov_kvp_dynamic_pool;
 
@@ -726,6 +733,12 @@ unsigned __gcov_kvp_dynamic_pool_size;
 void
 __gcov_exit (void)
 {
+  /* The dump thread runs code of this object if it started it.  */
+  __gcov_dump_periodic_stop ();
+
+  /* Do not race with the periodic dumps started by another object, which
+     walk the master list.  */
+  __gcov_lock ();
   __gcov_dump_one (&__gcov_root);
   if (__gcov_root.next)
     __gcov_root.next->prev = __gcov_root.prev;
@@ -733,6 +746,9 @@ __gcov_exit (void)
     __gcov_root.prev->next = __gcov_root.next;
   else
     __gcov_master.root = __gcov_root.next;
+  __gcov_unlock ();
+  if (__gcov_thread_counters_release)
+    __gcov_thread_counters_release ();
 
   gcov_error_exit ();
 }
@@ -752,6 +768,11 @@ __gcov_init (struct gcov_info *info)
 	  /* Add to master list and at exit function.  */
 	  if (gcov_version (NULL, __gcov_master.version, "<master>"))
 	    {
+	      /* The periodic dumps handle all objects, so only the first
+		 one starts them.  */
+	      if (!__gcov_master.root)
+		__gcov_dump_periodic_start ();
+
 	      __gcov_root.next = __gcov_master.root;
 	      if (__gcov_master.root)
 		__gcov_master.root->prev = &__gcov_root;
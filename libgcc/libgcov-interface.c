@@ -120,6 +120,10 @@ __gcov_reset_int (void)
 {
   struct gcov_root *root;
 
+  /* Discard the counts of the per-thread copies too.  */
+  if (__gcov_thread_counters_flush)
+    __gcov_thread_counters_flush ();
+
   /* If we're compatible with the master, iterate over everything,
      otherise just do us.  */
   for (root = __gcov_master.version == GCOV_VERSION
@@ -172,6 +176,200 @@ __gcov_dump (void)
   __gcov_unlock ();
 }
 
+#ifdef __GTHREADS_CXX0X
+#include <time.h>
+
+/* The interval of the periodic dumps in seconds, or zero.  */
+static long gcov_dump_interval;
+
+/* The thread doing the periodic dumps, if gcov_dump_running.  Only the
+   copy of libgcov linked into the object that started the thread has
+   these set, and that object stops the thread from its __gcov_exit, so
+   that the thread never runs code of an unloaded object.  */
+static __gthread_t gcov_dump_thread;
+static int gcov_dump_running;
+
+/* Set to ask the dump thread to stop, protected by gcov_dump_mx.  */
+static int gcov_dump_stop;
+
+#ifdef __GTHREAD_MUTEX_INIT
+static __gthread_mutex_t gcov_dump_mx = __GTHREAD_MUTEX_INIT;
+#else
+static __gthread_mutex_t gcov_dump_mx;
+#endif
+
+#ifdef __GTHREAD_COND_INIT
+static __gthread_cond_t gcov_dump_cond = __GTHREAD_COND_INIT;
+#else
+static __gthread_cond_t gcov_dump_cond;
+#endif
+
+/* Dump the profile every gcov_dump_interval seconds until asked to stop.
+
+   Threads updating the counters are not stopped meanwhile, only other
+   dumps and resets are excluded by the gcov lock.  Counter updates made
+   while a counter is written go to either this dump or the next one, and
+   those made between writing a counter and resetting it are lost, like
+   with a __gcov_dump followed by a __gcov_reset from the program.  */
+
+static void *
+gcov_dump_periodic (void *arg __attribute__ ((unused)))
+{
+  while (1)
+    {
+      __gthread_time_t deadline;
+      int stop;
+
+      deadline.tv_sec = time (NULL) + gcov_dump_interval;
+      deadline.tv_nsec = 0;
+
+      __gthread_mutex_lock (&gcov_dump_mx);
+      while (!gcov_dump_stop && time (NULL) < deadline.tv_sec)
+	__gthread_cond_timedwait (&gcov_dump_cond, &gcov_dump_mx, &deadline);
+      stop = gcov_dump_stop;
+      __gthread_mutex_unlock (&gcov_dump_mx);
+
+      if (stop)
+	break;
+
+      __gcov_lock ();
+      __gcov_dump_int ();
+      __gcov_reset_int ();
+      __gcov_unlock ();
+    }
+  return NULL;
+}
+
+/* Start the thread doing the periodic dumps.  */
+
+static void
+gcov_dump_periodic_create (void)
+{
+  gcov_dump_stop = 0;
+  gcov_dump_running
+    = __gthread_create (&gcov_dump_thread, gcov_dump_periodic, NULL) == 0;
+}
+
+#if defined (_POSIX_THREADS) && defined (__gthrw)
+#include <pthread.h>
+
+/* The fork handlers are referenced weakly like the other pthread
+   functions, so that programs not linked with the threads library still
+   link.  glibc's pthread_atfork is a wrapper in libc_nonshared.a passing
+   the handle of the calling object, so that the handlers are dropped when
+   the object is unloaded; a weak reference does not pull it in and would
+   bind to the compatibility symbol in libc.so.6 which keeps them, so call
+   the function it wraps instead.  */
+#ifdef __GLIBC__
+extern int __register_atfork (void (*) (void), void (*) (void),
+			      void (*) (void), void *);
+extern void *__dso_handle __attribute__ ((__visibility__ ("hidden")));
+__gthrw (__register_atfork)
+#define GCOV_ATFORK(PREPARE, PARENT, CHILD) \
+  __gthrw_(__register_atfork) (PREPARE, PARENT, CHILD, __dso_handle)
+#define GCOV_ATFORK_FN __gthrw_(__register_atfork)
+#else
+__gthrw (pthread_atfork)
+#define GCOV_ATFORK(PREPARE, PARENT, CHILD) \
+  __gthrw_(pthread_atfork) (PREPARE, PARENT, CHILD)
+#define GCOV_ATFORK_FN __gthrw_(pthread_atfork)
+#endif
+
+#if SUPPORTS_WEAK && GTHREAD_USE_WEAK
+#define GCOV_HAVE_ATFORK (GCOV_ATFORK_FN != NULL)
+#else
+#define GCOV_HAVE_ATFORK 1
+#endif
+
+/* The dump thread does not survive fork, but forked children such as
+   daemons are the processes that need it most.  Hold the gcov lock and
+   the dump thread lock across fork so that the child does not inherit a
+   half-written dump, and restart the thread in the child.  */
+
+static void
+gcov_dump_periodic_prepare (void)
+{
+  __gcov_lock ();
+  __gthread_mutex_lock (&gcov_dump_mx);
+}
+
+static void
+gcov_dump_periodic_parent (void)
+{
+  __gthread_mutex_unlock (&gcov_dump_mx);
+  __gcov_unlock ();
+}
+
+static void
+gcov_dump_periodic_child (void)
+{
+  int running = gcov_dump_running && !gcov_dump_stop;
+
+  __gthread_mutex_unlock (&gcov_dump_mx);
+  __gcov_unlock ();
+  gcov_dump_running = 0;
+  if (running)
+    gcov_dump_periodic_create ();
+}
+#endif
+#endif
+
+/* If GCOV_DUMP_INTERVAL is set, start a thread dumping the profile every
+   GCOV_DUMP_INTERVAL seconds, so that the profile of processes which do
+   not exit can be collected while they are running.  The counters are
+   reset after each dump, so the .gcda files accumulate the counts since
+   the previous dump and always hold the profile of the whole run so
+   far.  Forked children keep dumping their own profile.  */
+
+void
+__gcov_dump_periodic_start (void)
+{
+#ifdef __GTHREADS_CXX0X
+  const char *env = getenv ("GCOV_DUMP_INTERVAL");
+  long interval = env ? atol (env) : 0;
+
+  if (interval <= 0 || gcov_dump_running || !__gthread_active_p ())
+    return;
+
+#ifndef __GTHREAD_MUTEX_INIT
+  __GTHREAD_MUTEX_INIT_FUNCTION (&gcov_dump_mx);
+#endif
+#ifndef __GTHREAD_COND_INIT
+  __GTHREAD_COND_INIT_FUNCTION (&gcov_dump_cond);
+#endif
+
+  gcov_dump_interval = interval;
+#if defined (_POSIX_THREADS) && defined (__gthrw)
+  if (GCOV_HAVE_ATFORK)
+    GCOV_ATFORK (gcov_dump_periodic_prepare, gcov_dump_periodic_parent,
+		 gcov_dump_periodic_child);
+#endif
+  gcov_dump_periodic_create ();
+#endif
+}
+
+/* Stop and join the thread doing the periodic dumps, if this object
+   started it.  The periodic dumps end with the object that started them;
+   the remaining objects are still dumped at their exit.  Must be called
+   without the gcov lock held.  */
+
+void
+__gcov_dump_periodic_stop (void)
+{
+#ifdef __GTHREADS_CXX0X
+  if (!gcov_dump_running)
+    return;
+
+  __gthread_mutex_lock (&gcov_dump_mx);
+  gcov_dump_stop = 1;
+  __gthread_cond_broadcast (&gcov_dump_cond);
+  __gthread_mutex_unlock (&gcov_dump_mx);
+
+  __gthread_join (gcov_dump_thread, NULL);
+  gcov_dump_running = 0;
+#endif
+}
+
 #endif /* L_gcov_dump */
 
 #ifdef L_gcov_fork
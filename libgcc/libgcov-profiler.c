@@ -234,4 +234,206 @@ __gcov_ior_profiler_atomic (gcov_type *counters, gcov_type value)
 #endif
 
 
+#ifdef L_gcov_thread_counters_register
+#include "gthr.h"
+
+/* With -fprofile-update=per-thread the instrumented code increments the
+   arc counters in thread-local copies, which every thread registers here
+   on the first entry of each function.  The copies are added to the
+   counters when the thread exits and before the profile is dumped or
+   reset.  */
+
+/* A thread-local copy of the arc counters of a function.  MERGED holds
+   the values of SHADOW already added to COUNTERS.  */
+
+struct gcov_thread_counters
+{
+  gcov_type *shadow;
+  gcov_type *counters;
+  unsigned num;
+  struct gcov_thread_counters *next;
+  gcov_type merged[1];
+};
+
+/* The copies registered by a thread.  */
+
+struct gcov_thread
+{
+  struct gcov_thread_counters *counters;
+  struct gcov_thread *next;
+  struct gcov_thread **prev;
+};
+
+/* All threads that registered copies, protected by gcov_threads_mx.  */
+static struct gcov_thread *gcov_threads;
+
+#ifdef __GTHREAD_MUTEX_INIT
+static __gthread_mutex_t gcov_threads_mx = __GTHREAD_MUTEX_INIT;
+#else
+static __gthread_mutex_t gcov_threads_mx;
+#endif
+
+static __gthread_key_t gcov_thread_key;
+static int gcov_thread_key_valid;
+
+/* The copies registered by the current thread.  */
+static
+#if defined(HAVE_CC_TLS) && !defined (USE_EMUTLS)
+__thread
+#endif
+struct gcov_thread *gcov_current_thread;
+
+/* Add what the copies of thread T counted since they were last merged
+   to the counters.  The copies are only ever written by their thread,
+   which may keep a counter in a register for the duration of a loop, so
+   they are never cleared here: a copy only grows, and the differences
+   added over time sum up to its final value, which is merged when the
+   thread exits.  Called with gcov_threads_mx held.  */
+
+static void
+gcov_thread_merge (struct gcov_thread *t)
+{
+  struct gcov_thread_counters *c;
+
+  for (c = t->counters; c; c = c->next)
+    for (unsigned i = 0; i < c->num; i++)
+      {
+#if GCOV_SUPPORTS_ATOMIC
+	gcov_type value = __atomic_load_n (&c->shadow[i], __ATOMIC_RELAXED);
+#else
+	gcov_type value = c->shadow[i];
+#endif
+	c->counters[i] += value - c->merged[i];
+	c->merged[i] = value;
+      }
+}
+
+/* Merge the copies of all threads.  */
+
+static void
+gcov_thread_counters_flush (void)
+{
+  struct gcov_thread *t;
+
+  __gthread_mutex_lock (&gcov_threads_mx);
+  for (t = gcov_threads; t; t = t->next)
+    gcov_thread_merge (t);
+  __gthread_mutex_unlock (&gcov_threads_mx);
+}
+
+/* Merge the copies of the exiting thread ARG and forget about them.  */
+
+static void
+gcov_thread_exit (void *arg)
+{
+  struct gcov_thread *t = (struct gcov_thread *) arg;
+  struct gcov_thread_counters *c, *next;
+
+  __gthread_mutex_lock (&gcov_threads_mx);
+  gcov_thread_merge (t);
+  /* Records detached by gcov_thread_counters_release are not in the
+     list anymore.  */
+  if (t->prev)
+    {
+      *t->prev = t->next;
+      if (t->next)
+	t->next->prev = t->prev;
+    }
+  __gthread_mutex_unlock (&gcov_threads_mx);
+
+  for (c = t->counters; c; c = next)
+    {
+      next = c->next;
+      free (c);
+    }
+  free (t);
+}
+
+/* Stop tracking the copies when the object is unloaded or the program
+   exits.  Every object has its own copy of this code, so the thread key
+   must not outlive it: its destructor would run from unmapped code when
+   the remaining threads exit after dlclose.  The thread records are not
+   freed, as threads still running may refer to them.  */
+
+static void
+gcov_thread_counters_release (void)
+{
+  __gthread_mutex_lock (&gcov_threads_mx);
+  if (gcov_thread_key_valid)
+    {
+      __gthread_key_delete (gcov_thread_key);
+      gcov_thread_key_valid = 0;
+    }
+  while (gcov_threads)
+    {
+      struct gcov_thread *t = gcov_threads;
+      gcov_threads = t->next;
+      t->next = NULL;
+      t->prev = NULL;
+    }
+  __gcov_thread_counters_flush = 0;
+  __gthread_mutex_unlock (&gcov_threads_mx);
+}
+
+/* Set up the merging of the copies.  */
+
+static void
+gcov_thread_init (void)
+{
+#ifndef __GTHREAD_MUTEX_INIT
+  __GTHREAD_MUTEX_INIT_FUNCTION (&gcov_threads_mx);
+#endif
+  if (__gthread_active_p ()
+      && __gthread_key_create (&gcov_thread_key, gcov_thread_exit) == 0)
+    gcov_thread_key_valid = 1;
+  __gcov_thread_counters_flush = gcov_thread_counters_flush;
+  __gcov_thread_counters_release = gcov_thread_counters_release;
+}
+
+/* Register SHADOW as the copy of the NUM arc counters COUNTERS of the
+   current thread.  SHADOW[NUM] is set so the instrumented code does not
+   register it again.  */
+
+void
+__gcov_thread_counters_register (gcov_type *shadow, gcov_type *counters,
+				 unsigned num)
+{
+  static __gthread_once_t once = __GTHREAD_ONCE_INIT;
+  struct gcov_thread *t = gcov_current_thread;
+  struct gcov_thread_counters *c;
+
+  if (__gthread_active_p ())
+    __gthread_once (&once, gcov_thread_init);
+  else if (!__gcov_thread_counters_flush)
+    gcov_thread_init ();
+
+  c = (struct gcov_thread_counters *) xmalloc (sizeof (*c)
+					       + num * sizeof (gcov_type));
+  c->shadow = shadow;
+  c->counters = counters;
+  c->num = num;
+  memset (c->merged, 0, num * sizeof (gcov_type));
+
+  __gthread_mutex_lock (&gcov_threads_mx);
+  if (!t)
+    {
+      t = (struct gcov_thread *) xmalloc (sizeof (*t));
+      t->counters = NULL;
+      t->next = gcov_threads;
+      t->prev = &gcov_threads;
+      if (gcov_threads)
+	gcov_threads->prev = &t->next;
+      gcov_threads = t;
+      gcov_current_thread = t;
+      if (gcov_thread_key_valid)
+	__gthread_setspecific (gcov_thread_key, t);
+    }
+  c->next = t->counters;
+  t->counters = c;
+  __gthread_mutex_unlock (&gcov_threads_mx);
+
+  shadow[num] = 1;
+}
+#endif
+
 #endif /* inhibit_libc */
@@ -296,6 +296,20 @@ extern void __gcov_reset_int (void) ATTRIBUTE_HIDDEN;
 /* User function to enable early write of profile information so far.  */
 extern void __gcov_dump_int (void) ATTRIBUTE_HIDDEN;
 
+/* Start dumping the profile periodically if requested.  */
+extern void __gcov_dump_periodic_start (void) ATTRIBUTE_HIDDEN;
+
+/* Stop dumping the profile periodically if this object started it.  */
+extern void __gcov_dump_periodic_stop (void) ATTRIBUTE_HIDDEN;
+
+/* Merge the per-thread copies of the arc counters into the counters, if
+   any have been registered.  */
+extern void (*__gcov_thread_counters_flush) (void) ATTRIBUTE_HIDDEN;
+
+/* Stop tracking the per-thread copies of the arc counters, if any have
+   been registered.  */
+extern void (*__gcov_thread_counters_release) (void) ATTRIBUTE_HIDDEN;
+
 /* Lock critical section for __gcov_dump and __gcov_reset functions.  */
 extern void __gcov_lock (void) ATTRIBUTE_HIDDEN;
 
@@ -330,6 +344,8 @@ extern void __gcov_average_profiler (gcov_type *, gcov_type);
 extern void __gcov_average_profiler_atomic (gcov_type *, gcov_type);
 extern void __gcov_ior_profiler (gcov_type *, gcov_type);
 extern void __gcov_ior_profiler_atomic (gcov_type *, gcov_type);
+extern void __gcov_thread_counters_register (gcov_type *, gcov_type *,
+					     unsigned);
 
 #ifndef inhibit_libc
 /* The wrappers around some library functions..  */
@@ -34,6 +34,29 @@
 
 #define omp_max_predefined_alloc omp_thread_mem_alloc
 
+/* The following macros obtain and release the memory backing an
+   allocation.  DATA is the struct omp_allocator_data of the allocator,
+   or NULL for the predefined allocators, and SIZE is the full size
+   including struct omp_mem_header, as recorded in the header.  Targets
+   which can honor traits such as omp_atk_pinned override them.  */
+
+#ifndef MEMSPACE_VALIDATE
+#define MEMSPACE_VALIDATE(MEMSPACE, PINNED) (!(PINNED))
+#endif
+#ifndef MEMSPACE_ALLOC
+#define MEMSPACE_ALLOC(DATA, SIZE) malloc (SIZE)
+#endif
+#ifndef MEMSPACE_CALLOC
+#define MEMSPACE_CALLOC(DATA, SIZE) calloc (1, SIZE)
+#endif
+#ifndef MEMSPACE_REALLOC
+#define MEMSPACE_REALLOC(OLDDATA, DATA, ADDR, OLDSIZE, SIZE) \
+  realloc (ADDR, SIZE)
+#endif
+#ifndef MEMSPACE_FREE
+#define MEMSPACE_FREE(DATA, ADDR, SIZE) free (ADDR)
+#endif
+
 struct omp_allocator_data
 {
   omp_memspace_handle_t memspace;
@@ -179,8 +202,9 @@ omp_init_allocator (omp_memspace_handle_t memspace, int ntraits,
   if (data.alignment < sizeof (void *))
     data.alignment = sizeof (void *);
 
-  /* No support for these so far (for hbw will use memkind).  */
-  if (data.pinned || data.memspace == omp_high_bw_mem_space)
+  /* No support for hbw so far (will use memkind).  */
+  if (data.memspace == omp_high_bw_mem_space
+      || !MEMSPACE_VALIDATE (data.memspace, data.pinned))
     return omp_null_allocator;
 
   ret = gomp_malloc (sizeof (struct omp_allocator_data));
@@ -281,7 +305,7 @@ retry:
       allocator_data->used_pool_size = used_pool_size;
       gomp_mutex_unlock (&allocator_data->lock);
 #endif
-      ptr = malloc (new_size);
+      ptr = MEMSPACE_ALLOC (allocator_data, new_size);
       if (ptr == NULL)
 	{
 #ifdef HAVE_SYNC_BUILTINS
@@ -297,7 +321,7 @@ retry:
     }
   else
     {
-      ptr = malloc (new_size);
+      ptr = MEMSPACE_ALLOC (allocator_data, new_size);
       if (ptr == NULL)
 	goto fail;
     }
@@ -322,7 +346,8 @@ fail:
 	case omp_atv_default_mem_fb:
 	  if ((new_alignment > sizeof (void *) && new_alignment > alignment)
 	      || (allocator_data
-		  && allocator_data->pool_size < ~(uintptr_t) 0))
+		  && (allocator_data->pool_size < ~(uintptr_t) 0
+		      || allocator_data->pinned)))
 	    {
 	      allocator = omp_default_mem_alloc;
 	      goto retry;
@@ -373,6 +398,7 @@ void
 omp_free (void *ptr, omp_allocator_handle_t allocator)
 {
   struct omp_mem_header *data;
+  struct omp_allocator_data *allocator_data = NULL;
 
   if (ptr == NULL)
     return;
@@ -380,8 +406,7 @@ omp_free (void *ptr, omp_allocator_handle_t allocator)
   data = &((struct omp_mem_header *) ptr)[-1];
   if (data->allocator > omp_max_predefined_alloc)
     {
-      struct omp_allocator_data *allocator_data
-	= (struct omp_allocator_data *) (data->allocator);
+      allocator_data = (struct omp_allocator_data *) (data->allocator);
       if (allocator_data->pool_size < ~(uintptr_t) 0)
 	{
 #ifdef HAVE_SYNC_BUILTINS
@@ -394,7 +419,7 @@ omp_free (void *ptr, omp_allocator_handle_t allocator)
 #endif
 	}
     }
-  free (data->ptr);
+  MEMSPACE_FREE (allocator_data, data->ptr, data->size);
 }
 
 ialias (omp_free)
@@ -482,7 +507,7 @@ retry:
       allocator_data->used_pool_size = used_pool_size;
       gomp_mutex_unlock (&allocator_data->lock);
 #endif
-      ptr = calloc (1, new_size);
+      ptr = MEMSPACE_CALLOC (allocator_data, new_size);
       if (ptr == NULL)
 	{
 #ifdef HAVE_SYNC_BUILTINS
@@ -498,7 +523,7 @@ retry:
     }
   else
     {
-      ptr = calloc (1, new_size);
+      ptr = MEMSPACE_CALLOC (allocator_data, new_size);
       if (ptr == NULL)
 	goto fail;
     }
@@ -523,7 +548,8 @@ fail:
 	case omp_atv_default_mem_fb:
 	  if ((new_alignment > sizeof (void *) && new_alignment > alignment)
 	      || (allocator_data
-		  && allocator_data->pool_size < ~(uintptr_t) 0))
+		  && (allocator_data->pool_size < ~(uintptr_t) 0
+		      || allocator_data->pinned)))
 	    {
 	      allocator = omp_default_mem_alloc;
 	      goto retry;
@@ -660,9 +686,10 @@ retry:
       gomp_mutex_unlock (&allocator_data->lock);
 #endif
       if (prev_size)
-	new_ptr = realloc (data->ptr, new_size);
+	new_ptr = MEMSPACE_REALLOC (free_allocator_data, allocator_data,
+				    data->ptr, data->size, new_size);
       else
-	new_ptr = malloc (new_size);
+	new_ptr = MEMSPACE_ALLOC (allocator_data, new_size);
       if (new_ptr == NULL)
 	{
 #ifdef HAVE_SYNC_BUILTINS
@@ -690,7 +717,8 @@ retry:
 	   && (free_allocator_data == NULL
 	       || free_allocator_data->pool_size == ~(uintptr_t) 0))
     {
-      new_ptr = realloc (data->ptr, new_size);
+      new_ptr = MEMSPACE_REALLOC (free_allocator_data, allocator_data,
+				  data->ptr, data->size, new_size);
       if (new_ptr == NULL)
 	goto fail;
       ret = (char *) new_ptr + sizeof (struct omp_mem_header);
@@ -701,7 +729,7 @@ retry:
     }
   else
     {
-      new_ptr = malloc (new_size);
+      new_ptr = MEMSPACE_ALLOC (allocator_data, new_size);
       if (new_ptr == NULL)
 	goto fail;
     }
@@ -731,7 +759,7 @@ retry:
       gomp_mutex_unlock (&free_allocator_data->lock);
 #endif
     }
-  free (data->ptr);
+  MEMSPACE_FREE (free_allocator_data, data->ptr, data->size);
   return ret;
 
 fail:
@@ -742,7 +770,8 @@ fail:
 	case omp_atv_default_mem_fb:
 	  if (new_alignment > sizeof (void *)
 	      || (allocator_data
-		  && allocator_data->pool_size < ~(uintptr_t) 0))
+		  && (allocator_data->pool_size < ~(uintptr_t) 0
+		      || allocator_data->pinned)))
 	    {
 	      allocator = omp_default_mem_alloc;
 	      goto retry;
@@ -31,6 +31,8 @@
 
 ialias (omp_init_lock)
 ialias (omp_init_nest_lock)
+ialias (omp_init_lock_with_hint)
+ialias (omp_init_nest_lock_with_hint)
 ialias (omp_destroy_lock)
 ialias (omp_destroy_nest_lock)
 ialias (omp_set_lock)
@@ -0,0 +1,387 @@
+/* Copyright (C) 2022 Free Software Foundation, Inc.
+
+   This file is part of the GNU Offloading and Multi Processing Library
+   (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* This file contains the Linux implementation of the memory placement
+   allocator traits.  Pinned allocations are backed by mlock'ed anonymous
+   mappings; the nearest and interleaved partitions are implemented by
+   binding anonymous mappings with the mbind system call.  Everything
+   else, and allocations too small to be placed, use malloc.  */
+
+#define _GNU_SOURCE
+#include "libgomp.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if defined(SYS_mbind) && defined(SYS_get_mempolicy) && defined(SYS_getcpu)
+#define LIBGOMP_USE_MBIND 1
+#endif
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+#ifndef MPOL_F_MEMS_ALLOWED
+#define MPOL_F_MEMS_ALLOWED (1 << 2)
+#endif
+
+/* Largest NUMA node number we are prepared to describe in a node mask.  */
+#define LINUX_MAX_NUMA_NODES 1024
+#define LINUX_NODEMASK_WORDS \
+  (LINUX_MAX_NUMA_NODES / (8 * sizeof (unsigned long)))
+
+struct omp_allocator_data;
+
+static void *linux_memspace_alloc (struct omp_allocator_data *, size_t, int);
+static void *linux_memspace_realloc (struct omp_allocator_data *,
+				     struct omp_allocator_data *, void *,
+				     size_t, size_t);
+static void linux_memspace_free (struct omp_allocator_data *, void *, size_t);
+
+#define MEMSPACE_VALIDATE(MEMSPACE, PINNED) 1
+#define MEMSPACE_ALLOC(DATA, SIZE) \
+  linux_memspace_alloc (DATA, SIZE, 0)
+#define MEMSPACE_CALLOC(DATA, SIZE) \
+  linux_memspace_alloc (DATA, SIZE, 1)
+#define MEMSPACE_REALLOC(OLDDATA, DATA, ADDR, OLDSIZE, SIZE) \
+  linux_memspace_realloc (OLDDATA, DATA, ADDR, OLDSIZE, SIZE)
+#define MEMSPACE_FREE(DATA, ADDR, SIZE) \
+  linux_memspace_free (DATA, ADDR, SIZE)
+
+#include "../../allocator.c"
+
+#ifdef LIBGOMP_USE_MBIND
+/* Mask of the NUMA nodes this process may allocate from, and their
+   count.  -1 means not yet determined.  */
+static unsigned long linux_numa_nodes[LINUX_NODEMASK_WORDS];
+static int linux_numa_node_count = -1;
+
+static int
+linux_numa_init (void)
+{
+  int count = __atomic_load_n (&linux_numa_node_count, MEMMODEL_ACQUIRE);
+  if (__builtin_expect (count >= 0, 1))
+    return count;
+
+  unsigned long mask[LINUX_NODEMASK_WORDS];
+  size_t i;
+  count = 0;
+  memset (mask, 0, sizeof (mask));
+  if (syscall (SYS_get_mempolicy, NULL, mask, LINUX_MAX_NUMA_NODES, NULL,
+	       MPOL_F_MEMS_ALLOWED) == 0)
+    for (i = 0; i < LINUX_NODEMASK_WORDS; i++)
+      count += __builtin_popcountl (mask[i]);
+  /* Racing initializers compute the same mask.  */
+  memcpy (linux_numa_nodes, mask, sizeof (mask));
+  __atomic_store_n (&linux_numa_node_count, count, MEMMODEL_RELEASE);
+  return count;
+}
+
+/* Apply the partition trait PARTITION to the mapping ADDR of SIZE bytes.
+   Placement is only a hint, so failures are ignored.  */
+
+static void
+linux_memspace_place (void *addr, size_t size, int partition)
+{
+  if (linux_numa_init () < 2)
+    return;
+  if (partition == omp_atv_interleaved)
+    syscall (SYS_mbind, addr, size, MPOL_INTERLEAVE, linux_numa_nodes,
+	     LINUX_MAX_NUMA_NODES, 0);
+  else
+    {
+      unsigned cpu, node;
+      unsigned long mask[LINUX_NODEMASK_WORDS];
+      if (syscall (SYS_getcpu, &cpu, &node, NULL) != 0
+	  || node >= LINUX_MAX_NUMA_NODES)
+	return;
+      memset (mask, 0, sizeof (mask));
+      mask[node / (8 * sizeof (unsigned long))]
+	|= 1UL << (node % (8 * sizeof (unsigned long)));
+      syscall (SYS_mbind, addr, size, MPOL_PREFERRED, mask,
+	       LINUX_MAX_NUMA_NODES, 0);
+    }
+}
+#endif
+
+/* Small pinned allocations are carved out of larger locked chunks
+   instead of getting a mapping, an mlock and a munmap each.  Blocks are
+   powers of two between LINUX_PINNED_MIN and LINUX_PINNED_MAX bytes, and
+   freed blocks are kept on a free list per size class for reuse; the
+   chunks themselves are never unmapped.  */
+
+#define LINUX_PINNED_MIN_LOG 6
+#define LINUX_PINNED_MAX_LOG 14
+#define LINUX_PINNED_MIN ((size_t) 1 << LINUX_PINNED_MIN_LOG)
+#define LINUX_PINNED_MAX ((size_t) 1 << LINUX_PINNED_MAX_LOG)
+#define LINUX_PINNED_CLASSES (LINUX_PINNED_MAX_LOG - LINUX_PINNED_MIN_LOG + 1)
+/* Preferred size of a chunk; smaller ones are tried if locking that much
+   at once fails.  */
+#define LINUX_PINNED_CHUNK ((size_t) 256 * 1024)
+
+struct linux_pinned_block
+{
+  struct linux_pinned_block *next;
+};
+
+static struct
+{
+  gomp_mutex_t lock;
+  /* Free blocks of each size class.  */
+  struct linux_pinned_block *free_list[LINUX_PINNED_CLASSES];
+  /* Not yet used part of the current chunk.  */
+  char *chunk_ptr;
+  size_t chunk_left;
+} linux_pinned_pool;
+
+static size_t linux_page_size;
+
+static inline size_t
+linux_get_page_size (void)
+{
+  size_t page_size = __atomic_load_n (&linux_page_size, MEMMODEL_RELAXED);
+  if (__builtin_expect (page_size == 0, 0))
+    {
+      page_size = sysconf (_SC_PAGESIZE);
+      __atomic_store_n (&linux_page_size, page_size, MEMMODEL_RELAXED);
+    }
+  return page_size;
+}
+
+/* Return the size class of a pooled block of SIZE bytes.  */
+
+static inline int
+linux_pinned_class (size_t size)
+{
+  if (size <= LINUX_PINNED_MIN)
+    return 0;
+  return (8 * sizeof (long) - __builtin_clzl (size - 1)
+	  - LINUX_PINNED_MIN_LOG);
+}
+
+/* Allocate a block of size class CLASS from the pinned pool, clearing it
+   if ZERO.  */
+
+static void *
+linux_pinned_pool_alloc (int class, int zero)
+{
+  size_t block_size = LINUX_PINNED_MIN << class;
+  struct linux_pinned_block *block;
+  void *ret;
+
+  gomp_mutex_lock (&linux_pinned_pool.lock);
+  block = linux_pinned_pool.free_list[class];
+  if (block)
+    {
+      linux_pinned_pool.free_list[class] = block->next;
+      gomp_mutex_unlock (&linux_pinned_pool.lock);
+      if (zero)
+	memset (block, 0, block_size);
+      return block;
+    }
+  if (linux_pinned_pool.chunk_left < block_size)
+    {
+      size_t page_size = linux_get_page_size ();
+      size_t chunk_size = LINUX_PINNED_CHUNK;
+      void *chunk;
+
+      if (chunk_size < block_size)
+	chunk_size = block_size;
+      for (;;)
+	{
+	  if (chunk_size < page_size)
+	    chunk_size = page_size;
+	  chunk = mmap (NULL, chunk_size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	  if (chunk == MAP_FAILED)
+	    chunk = NULL;
+	  else if (mlock (chunk, chunk_size))
+	    {
+	      munmap (chunk, chunk_size);
+	      chunk = NULL;
+	    }
+	  if (chunk || chunk_size <= block_size || chunk_size <= page_size)
+	    break;
+	  chunk_size /= 2;
+	}
+      if (chunk == NULL)
+	{
+	  gomp_mutex_unlock (&linux_pinned_pool.lock);
+	  gomp_debug (0, "libgomp: failed to pin %lu bytes of memory"
+		      " (ulimit -l too low?)\n", (unsigned long) chunk_size);
+	  return NULL;
+	}
+      /* Put what is left of the old chunk on the free lists.  It is a
+	 multiple of LINUX_PINNED_MIN bytes, like all block sizes, so every
+	 block stays suitably aligned for any object.  */
+      while (linux_pinned_pool.chunk_left >= LINUX_PINNED_MIN)
+	{
+	  int c = linux_pinned_class (linux_pinned_pool.chunk_left + 1) - 1;
+	  block = (struct linux_pinned_block *) linux_pinned_pool.chunk_ptr;
+	  block->next = linux_pinned_pool.free_list[c];
+	  linux_pinned_pool.free_list[c] = block;
+	  linux_pinned_pool.chunk_ptr += LINUX_PINNED_MIN << c;
+	  linux_pinned_pool.chunk_left -= LINUX_PINNED_MIN << c;
+	}
+      linux_pinned_pool.chunk_ptr = (char *) chunk;
+      linux_pinned_pool.chunk_left = chunk_size;
+    }
+  ret = linux_pinned_pool.chunk_ptr;
+  linux_pinned_pool.chunk_ptr += block_size;
+  linux_pinned_pool.chunk_left -= block_size;
+  gomp_mutex_unlock (&linux_pinned_pool.lock);
+  /* Fresh chunks are zero filled, so ZERO needs no work.  */
+  return ret;
+}
+
+static void
+linux_pinned_pool_free (void *addr, int class)
+{
+  struct linux_pinned_block *block = (struct linux_pinned_block *) addr;
+
+  gomp_mutex_lock (&linux_pinned_pool.lock);
+  block->next = linux_pinned_pool.free_list[class];
+  linux_pinned_pool.free_list[class] = block;
+  gomp_mutex_unlock (&linux_pinned_pool.lock);
+}
+
+/* How an allocation of SIZE bytes for allocator DATA is backed.  */
+
+enum linux_memspace_kind
+{
+  linux_memspace_malloc,
+  linux_memspace_pinned_pool,
+  linux_memspace_mapping
+};
+
+static inline enum linux_memspace_kind
+linux_memspace_kind (struct omp_allocator_data *data, size_t size)
+{
+  if (data == NULL)
+    return linux_memspace_malloc;
+#ifdef LIBGOMP_USE_MBIND
+  if ((data->partition == omp_atv_nearest
+       || data->partition == omp_atv_interleaved)
+      && size >= linux_get_page_size ())
+    return linux_memspace_mapping;
+#endif
+  /* Smaller allocations share pages with others, so cannot be placed
+     on their own.  */
+  if (data->pinned)
+    return (size <= LINUX_PINNED_MAX
+	    ? linux_memspace_pinned_pool : linux_memspace_mapping);
+  return linux_memspace_malloc;
+}
+
+static void *
+linux_memspace_alloc (struct omp_allocator_data *data, size_t size,
+		      int zero)
+{
+  void *addr;
+
+  switch (linux_memspace_kind (data, size))
+    {
+    case linux_memspace_malloc:
+      return zero ? calloc (1, size) : malloc (size);
+    case linux_memspace_pinned_pool:
+      return linux_pinned_pool_alloc (linux_pinned_class (size), zero);
+    default:
+      break;
+    }
+
+  /* Fresh anonymous mappings are zero filled, so ZERO needs no work.  */
+  addr = mmap (NULL, size, PROT_READ | PROT_WRITE,
+	       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED)
+    return NULL;
+#ifdef LIBGOMP_USE_MBIND
+  if (data->partition == omp_atv_nearest
+      || data->partition == omp_atv_interleaved)
+    linux_memspace_place (addr, size, data->partition);
+#endif
+  if (data->pinned && mlock (addr, size))
+    {
+      gomp_debug (0, "libgomp: failed to pin %lu bytes of memory"
+		  " (ulimit -l too low?)\n", (unsigned long) size);
+      munmap (addr, size);
+      return NULL;
+    }
+  return addr;
+}
+
+static void *
+linux_memspace_realloc (struct omp_allocator_data *olddata,
+			struct omp_allocator_data *data, void *addr,
+			size_t oldsize, size_t size)
+{
+  enum linux_memspace_kind old_kind = linux_memspace_kind (olddata, oldsize);
+  enum linux_memspace_kind kind = linux_memspace_kind (data, size);
+  void *ret;
+
+  if (old_kind == linux_memspace_malloc && kind == linux_memspace_malloc)
+    return realloc (addr, size);
+  /* A pooled block which is still large enough can be kept.  */
+  if (old_kind == linux_memspace_pinned_pool
+      && kind == linux_memspace_pinned_pool
+      && linux_pinned_class (oldsize) == linux_pinned_class (size))
+    return addr;
+  /* mremap keeps both the locking and the memory policy of the mapping,
+     so it can be used whenever the traits are the same.  */
+  if (old_kind == linux_memspace_mapping
+      && kind == linux_memspace_mapping
+      && olddata->pinned == data->pinned
+      && olddata->partition == data->partition)
+    {
+      ret = mremap (addr, oldsize, size, MREMAP_MAYMOVE);
+      return ret == MAP_FAILED ? NULL : ret;
+    }
+  ret = linux_memspace_alloc (data, size, 0);
+  if (ret == NULL)
+    return NULL;
+  memcpy (ret, addr, oldsize < size ? oldsize : size);
+  linux_memspace_free (olddata, addr, oldsize);
+  return ret;
+}
+
+static void
+linux_memspace_free (struct omp_allocator_data *data, void *addr,
+		     size_t size)
+{
+  switch (linux_memspace_kind (data, size))
+    {
+    case linux_memspace_malloc:
+      free (addr);
+      break;
+    case linux_memspace_pinned_pool:
+      linux_pinned_pool_free (addr, linux_pinned_class (size));
+      break;
+    default:
+      munmap (addr, size);
+      break;
+    }
+}
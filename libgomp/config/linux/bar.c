@@ -40,6 +40,10 @@ gomp_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
       bar->awaited = bar->total;
       __atomic_store_n (&bar->generation, bar->generation + BAR_INCR,
 			MEMMODEL_RELEASE);
+      /* Unlike the team barrier, this one may be destroyed by a waiter
+	 as soon as the new generation is visible (see
+	 gomp_barrier_wait_last), so BAR->sleeping cannot be consulted
+	 here.  */
       futex_wake ((int *) &bar->generation, INT_MAX);
     }
   else
@@ -71,9 +75,36 @@ gomp_barrier_wait_last (gomp_barrier_t *bar)
     gomp_barrier_wait_end (bar, state);
 }
 
+/* Wait in the team barrier BAR while its generation is GENERATION.
+   Threads that block in the kernel are counted in BAR->sleeping, so
+   that gomp_team_barrier_wake can avoid the futex syscall when nobody
+   is blocked.  That is the common case both when tasks are being
+   created while the rest of the team is busy, and when the last thread
+   releases a barrier whose waiters are all still spinning, as happens
+   for short parallel loops with larger teams.  config/nvptx/bar.c and
+   config/rtems/bar.c include this file, so their gomp_barrier_t has the
+   field too.  */
+
+static inline void
+do_team_wait (gomp_barrier_t *bar, unsigned int generation)
+{
+  if (do_spin ((int *) &bar->generation, generation))
+    {
+      __atomic_add_fetch (&bar->sleeping, 1, MEMMODEL_SEQ_CST);
+      futex_wait ((int *) &bar->generation, generation);
+      __atomic_sub_fetch (&bar->sleeping, 1, MEMMODEL_RELAXED);
+    }
+}
+
 void
 gomp_team_barrier_wake (gomp_barrier_t *bar, int count)
 {
+  /* The caller has updated the generation.  Either a thread about to
+     block sees that and does not block, or we see it counted as
+     sleeping.  */
+  __atomic_thread_fence (MEMMODEL_SEQ_CST);
+  if (__atomic_load_n (&bar->sleeping, MEMMODEL_RELAXED) == 0)
+    return;
   futex_wake ((int *) &bar->generation, count == 0 ? INT_MAX : count);
 }
 
@@ -81,6 +112,7 @@ void
 gomp_team_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
 {
   unsigned int generation, gen;
+  unsigned long long wait_start;
 
   if (__builtin_expect (state & BAR_WAS_LAST, 0))
     {
@@ -100,16 +132,17 @@ gomp_team_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
 	  state &= ~BAR_CANCELLED;
 	  state += BAR_INCR - BAR_WAS_LAST;
 	  __atomic_store_n (&bar->generation, state, MEMMODEL_RELEASE);
-	  futex_wake ((int *) &bar->generation, INT_MAX);
+	  gomp_team_barrier_wake (bar, 0);
 	  return;
 	}
     }
 
+  wait_start = gomp_wait_stats_begin ();
   generation = state;
   state &= ~BAR_CANCELLED;
   do
     {
-      do_wait ((int *) &bar->generation, generation);
+      do_team_wait (bar, generation);
       gen = __atomic_load_n (&bar->generation, MEMMODEL_ACQUIRE);
       if (__builtin_expect (gen & BAR_TASK_PENDING, 0))
 	{
@@ -119,6 +152,7 @@ gomp_team_barrier_wait_end (gomp_barrier_t *bar, gomp_barrier_state_t state)
       generation |= gen & BAR_WAITING_FOR_TASK;
     }
   while (gen != state + BAR_INCR);
+  gomp_wait_stats_end (GOMP_WAIT_BARRIER, wait_start);
 }
 
 void
@@ -141,6 +175,7 @@ gomp_team_barrier_wait_cancel_end (gomp_barrier_t *bar,
 				   gomp_barrier_state_t state)
 {
   unsigned int generation, gen;
+  unsigned long long wait_start;
 
   if (__builtin_expect (state & BAR_WAS_LAST, 0))
     {
@@ -163,7 +198,7 @@ gomp_team_barrier_wait_cancel_end (gomp_barrier_t *bar,
 	{
 	  state += BAR_INCR - BAR_WAS_LAST;
 	  __atomic_store_n (&bar->generation, state, MEMMODEL_RELEASE);
-	  futex_wake ((int *) &bar->generation, INT_MAX);
+	  gomp_team_barrier_wake (bar, 0);
 	  return false;
 	}
     }
@@ -171,13 +206,17 @@ gomp_team_barrier_wait_cancel_end (gomp_barrier_t *bar,
   if (__builtin_expect (state & BAR_CANCELLED, 0))
     return true;
 
+  wait_start = gomp_wait_stats_begin ();
   generation = state;
   do
     {
-      do_wait ((int *) &bar->generation, generation);
+      do_team_wait (bar, generation);
       gen = __atomic_load_n (&bar->generation, MEMMODEL_ACQUIRE);
       if (__builtin_expect (gen & BAR_CANCELLED, 0))
-	return true;
+	{
+	  gomp_wait_stats_end (GOMP_WAIT_BARRIER, wait_start);
+	  return true;
+	}
       if (__builtin_expect (gen & BAR_TASK_PENDING, 0))
 	{
 	  gomp_barrier_handle_tasks (state);
@@ -186,6 +225,7 @@ gomp_team_barrier_wait_cancel_end (gomp_barrier_t *bar,
       generation |= gen & BAR_WAITING_FOR_TASK;
     }
   while (gen != state + BAR_INCR);
+  gomp_wait_stats_end (GOMP_WAIT_BARRIER, wait_start);
 
   return false;
 }
@@ -207,5 +247,5 @@ gomp_team_barrier_cancel (struct gomp_team *team)
     }
   team->barrier.generation |= BAR_CANCELLED;
   gomp_mutex_unlock (&team->task_lock);
-  futex_wake ((int *) &team->barrier.generation, INT_MAX);
+  gomp_team_barrier_wake (&team->barrier, 0);
 }
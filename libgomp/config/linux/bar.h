@@ -40,6 +40,8 @@ typedef struct
   unsigned generation;
   unsigned awaited __attribute__((aligned (64)));
   unsigned awaited_final;
+  /* Number of threads blocked in the kernel in the team barrier.  */
+  unsigned sleeping;
 } gomp_barrier_t;
 
 typedef unsigned int gomp_barrier_state_t;
@@ -59,6 +61,7 @@ static inline void gomp_barrier_init (gomp_barrier_t *bar, unsigned count)
   bar->awaited = count;
   bar->awaited_final = count;
   bar->generation = 0;
+  bar->sleeping = 0;
 }
 
 static inline void gomp_barrier_reinit (gomp_barrier_t *bar, unsigned count)
@@ -29,9 +29,170 @@
 
 #include <string.h>
 #include <unistd.h>
+#include <limits.h>
 #include <sys/syscall.h>
 #include "wait.h"
 
+/* Locks initialized with omp_sync_hint_contended are FIFO ticket locks
+   instead of gomp_mutex_t.  Their waiters are served in order and, while
+   spinning, only read the lock word, rather than all of them trying to
+   grab it whenever it is released.  Both counters of a ticket lock are
+   packed into the lock word, whose two top bits are always 10, which no
+   gomp_mutex_t value has.  TICKET_SLEEPING is set when some waiter might
+   be blocked in futex_wait.  */
+
+#define TICKET_LOCK		0x80000000u
+#define TICKET_KIND_MASK	0xc0000000u
+#define TICKET_SLEEPING		0x20000000u
+#define TICKET_SERVING_SHIFT	14
+#define TICKET_MASK		0x3fffu
+
+static inline bool
+ticket_lock_p (int val)
+{
+  return ((unsigned) val & TICKET_KIND_MASK) == TICKET_LOCK;
+}
+
+static inline unsigned
+ticket_serving (int val)
+{
+  return ((unsigned) val >> TICKET_SERVING_SHIFT) & TICKET_MASK;
+}
+
+/* Take the next ticket of the ticket lock LOCK, whose value was VAL, and
+   wait for it to be served.  */
+
+static void
+gomp_ticket_lock (int *lock, int val)
+{
+  unsigned ticket;
+  int newval;
+  unsigned long long wait_start;
+
+  do
+    {
+      ticket = (unsigned) val & TICKET_MASK;
+      newval = (int) (((unsigned) val & ~TICKET_MASK)
+		      | ((ticket + 1) & TICKET_MASK));
+    }
+  while (!__atomic_compare_exchange_n (lock, &val, newval, false,
+				       MEMMODEL_ACQUIRE, MEMMODEL_RELAXED));
+  if (ticket_serving (val) == ticket)
+    return;
+
+  wait_start = gomp_wait_stats_begin ();
+  val = newval;
+  while (ticket_serving (val) != ticket)
+    {
+      if (do_spin (lock, val))
+	{
+	  /* Spin timeout, nothing changed.  Ask for a wake up.  */
+	  if (!((unsigned) val & TICKET_SLEEPING))
+	    {
+	      newval = (int) ((unsigned) val | TICKET_SLEEPING);
+	      if (!__atomic_compare_exchange_n (lock, &val, newval, false,
+						MEMMODEL_ACQUIRE,
+						MEMMODEL_ACQUIRE))
+		continue;
+	      val = newval;
+	    }
+	  futex_wait (lock, val);
+	}
+      val = __atomic_load_n (lock, MEMMODEL_ACQUIRE);
+    }
+  gomp_wait_stats_end (GOMP_WAIT_MUTEX, wait_start);
+}
+
+static void
+gomp_ticket_unlock (int *lock)
+{
+  int val = __atomic_load_n (lock, MEMMODEL_RELAXED), newval;
+
+  do
+    newval = (int) (((unsigned) val
+		     & ~(TICKET_SLEEPING
+			 | (TICKET_MASK << TICKET_SERVING_SHIFT)))
+		    | (((ticket_serving (val) + 1) & TICKET_MASK)
+		       << TICKET_SERVING_SHIFT));
+  while (!__atomic_compare_exchange_n (lock, &val, newval, false,
+				       MEMMODEL_RELEASE, MEMMODEL_RELAXED));
+  /* All sleepers have to be woken, as we don't know which of them holds
+     the next ticket.  Spinning before sleeping keeps this rare.  */
+  if ((unsigned) val & TICKET_SLEEPING)
+    futex_wake (lock, INT_MAX);
+}
+
+static int
+gomp_ticket_trylock (int *lock, int val)
+{
+  unsigned ticket = (unsigned) val & TICKET_MASK;
+
+  if (ticket_serving (val) != ticket)
+    return 0;
+  return __atomic_compare_exchange_n (lock, &val,
+				      (int) (((unsigned) val & ~TICKET_MASK)
+					     | ((ticket + 1) & TICKET_MASK)),
+				      false, MEMMODEL_ACQUIRE,
+				      MEMMODEL_RELAXED);
+}
+
+/* omp_sync_hint_speculative is ignored: lock elision would need
+   transactional memory, which current processors mostly lack or have
+   disabled.  */
+
+static inline void
+linux_lock_init_hint (int *lock, omp_sync_hint_t hint)
+{
+  if ((hint & (omp_sync_hint_contended | omp_sync_hint_uncontended))
+      == omp_sync_hint_contended)
+    *lock = (int) TICKET_LOCK;
+  else
+    gomp_mutex_init (lock);
+}
+
+static inline void
+linux_lock_set (int *lock)
+{
+  int oldval = 0;
+
+  if (!__atomic_compare_exchange_n (lock, &oldval, 1, false,
+				    MEMMODEL_ACQUIRE, MEMMODEL_RELAXED))
+    {
+      if (__builtin_expect (ticket_lock_p (oldval), 0))
+	gomp_ticket_lock (lock, oldval);
+      else
+	gomp_mutex_lock_slow (lock, oldval);
+    }
+}
+
+static inline void
+linux_lock_unset (int *lock)
+{
+  /* The kind of the lock can't change while it is held.  */
+  if (__builtin_expect (ticket_lock_p (__atomic_load_n (lock,
+							MEMMODEL_RELAXED)),
+			0))
+    gomp_ticket_unlock (lock);
+  else
+    gomp_mutex_unlock (lock);
+}
+
+static inline int
+linux_lock_test (int *lock)
+{
+  int oldval = 0;
+
+  if (__atomic_compare_exchange_n (lock, &oldval, 1, false,
+				   MEMMODEL_ACQUIRE, MEMMODEL_RELAXED))
+    return 1;
+  return ticket_lock_p (oldval) && gomp_ticket_trylock (lock, oldval);
+}
+
+#define OMP_LOCK_INIT_HINT(LOCK, HINT) linux_lock_init_hint (LOCK, HINT)
+#define OMP_LOCK_SET(LOCK) linux_lock_set (LOCK)
+#define OMP_LOCK_UNSET(LOCK) linux_lock_unset (LOCK)
+#define OMP_LOCK_TEST(LOCK) linux_lock_test (LOCK)
+
 /* Reuse the generic implementation in terms of gomp_mutex_t.  */
 #include "../../lock.c"
 
@@ -173,3 +334,6 @@ ialias (omp_test_lock)
 ialias (omp_test_nest_lock)
 
 #endif
+
+ialias (omp_init_lock_with_hint)
+ialias (omp_init_nest_lock_with_hint)
@@ -32,8 +32,8 @@
 int gomp_futex_wake = FUTEX_WAKE | FUTEX_PRIVATE_FLAG;
 int gomp_futex_wait = FUTEX_WAIT | FUTEX_PRIVATE_FLAG;
 
-void
-gomp_mutex_lock_slow (gomp_mutex_t *mutex, int oldval)
+static inline void
+do_mutex_lock_slow (gomp_mutex_t *mutex, int oldval)
 {
   /* First loop spins a while.  */
   while (oldval == 1)
@@ -63,6 +63,14 @@ gomp_mutex_lock_slow (gomp_mutex_t *mutex, int oldval)
     do_wait (mutex, -1);
 }
 
+void
+gomp_mutex_lock_slow (gomp_mutex_t *mutex, int oldval)
+{
+  unsigned long long wait_start = gomp_wait_stats_begin ();
+  do_mutex_lock_slow (mutex, oldval);
+  gomp_wait_stats_end (GOMP_WAIT_MUTEX, wait_start);
+}
+
 void
 gomp_mutex_unlock_slow (gomp_mutex_t *mutex)
 {
@@ -39,6 +39,8 @@ typedef struct
   unsigned awaited;
   unsigned awaited_final;
   unsigned waiters;
+  /* Number of threads blocked in the team barrier, see linux/bar.c.  */
+  unsigned sleeping;
   gomp_mutex_t lock;
 } gomp_barrier_t;
 
@@ -60,6 +62,7 @@ static inline void gomp_barrier_init (gomp_barrier_t *bar, unsigned count)
   bar->awaited_final = count;
   bar->generation = 0;
   bar->waiters = 0;
+  bar->sleeping = 0;
   gomp_mutex_init (&bar->lock);
 }
 
@@ -41,6 +41,8 @@ typedef struct
   struct _Futex_Control futex;
   unsigned awaited __attribute__((aligned (64)));
   unsigned awaited_final;
+  /* Number of threads blocked in the team barrier, see linux/bar.c.  */
+  unsigned sleeping;
 } gomp_barrier_t;
 
 typedef unsigned int gomp_barrier_state_t;
@@ -60,6 +62,7 @@ static inline void gomp_barrier_init (gomp_barrier_t *bar, unsigned count)
   bar->awaited = count;
   bar->awaited_final = count;
   bar->generation = 0;
+  bar->sleeping = 0;
   _Futex_Initialize (&bar->futex);
 }
 
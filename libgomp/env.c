@@ -82,6 +82,7 @@ gomp_mutex_t gomp_managed_threads_lock;
 #endif
 unsigned long gomp_available_cpus = 1, gomp_managed_threads = 1;
 unsigned long long gomp_spin_count_var, gomp_throttled_spin_count_var;
+unsigned long gomp_thread_idle_time_var = 100;
 unsigned long *gomp_nthreads_var_list, gomp_nthreads_var_list_len;
 char *gomp_bind_var_list;
 unsigned long gomp_bind_var_list_len;
@@ -89,6 +90,8 @@ void **gomp_places_list;
 unsigned long gomp_places_list_len;
 uintptr_t gomp_def_allocator = omp_default_mem_alloc;
 int gomp_debug_var;
+bool gomp_wait_stats_var;
+unsigned long gomp_host_offload_var;
 unsigned int gomp_num_teams_var;
 int gomp_nteams_var;
 int gomp_teams_thread_limit_var;
@@ -1413,6 +1416,12 @@ omp_display_env (int verbose)
       fprintf (stderr, "  GOMP_SPINCOUNT = '%lu'\n",
 	       (unsigned long) gomp_spin_count_var);
 #endif
+      fprintf (stderr, "  GOMP_THREAD_IDLE_TIME = '%lu'\n",
+	       gomp_thread_idle_time_var);
+      fprintf (stderr, "  GOMP_WAIT_STATS = '%s'\n",
+	       gomp_wait_stats_var ? "TRUE" : "FALSE");
+      fprintf (stderr, "  GOMP_HOST_OFFLOAD = '%lu'\n",
+	       gomp_host_offload_var);
     }
 
   fputs ("OPENMP DISPLAY ENVIRONMENT END\n", stderr);
@@ -1483,6 +1492,10 @@ initialize_env (void)
 	= thread_limit_var > INT_MAX ? UINT_MAX : thread_limit_var;
     }
   parse_int_secure ("GOMP_DEBUG", &gomp_debug_var, true);
+  parse_boolean ("GOMP_WAIT_STATS", &gomp_wait_stats_var);
+  parse_unsigned_long ("GOMP_HOST_OFFLOAD", &gomp_host_offload_var, true);
+  parse_unsigned_long ("GOMP_THREAD_IDLE_TIME", &gomp_thread_idle_time_var,
+		       true);
 #ifndef HAVE_SYNC_BUILTINS
   gomp_mutex_init (&gomp_managed_threads_lock);
 #endif
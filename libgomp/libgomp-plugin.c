@@ -49,6 +49,12 @@ GOMP_PLUGIN_realloc (void *ptr, size_t size)
   return gomp_realloc (ptr, size);
 }
 
+unsigned long
+GOMP_PLUGIN_host_offload_devices (void)
+{
+  return gomp_host_offload_var;
+}
+
 void
 GOMP_PLUGIN_debug (int kind, const char *msg, ...)
 {
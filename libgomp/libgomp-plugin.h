@@ -113,6 +113,7 @@ extern void *GOMP_PLUGIN_malloc (size_t) __attribute__ ((malloc));
 extern void *GOMP_PLUGIN_malloc_cleared (size_t) __attribute__ ((malloc));
 extern void *GOMP_PLUGIN_realloc (void *, size_t);
 void GOMP_PLUGIN_target_task_completion (void *);
+extern unsigned long GOMP_PLUGIN_host_offload_devices (void);
 
 extern void GOMP_PLUGIN_debug (int, const char *, ...)
 	__attribute__ ((format (printf, 2, 3)));
@@ -390,6 +390,18 @@ struct gomp_work_share
   /* Task reductions for this work-sharing construct.  */
   uintptr_t *task_reductions;
 
+  /* For schedule(auto) loops whose schedule is chosen adaptively, the
+     call site record to update when the loop completes, otherwise NULL.  */
+  struct gomp_auto_sched_site *auto_site;
+
+  /* When the loop was started, the largest and total time in nanoseconds
+     threads needed from then to finish their share, and the number of
+     threads that have finished.  Only used if AUTO_SITE is non-NULL.  */
+  unsigned long long auto_start_ns;
+  unsigned long long auto_max_ns;
+  unsigned long long auto_sum_ns;
+  unsigned auto_done;
+
   /* If only few threads are in the team, ordered_team_ids can point
      to this array which fills the padding at the end of this struct.  */
   unsigned inline_ordered_team_ids[0];
@@ -490,6 +502,7 @@ extern bool gomp_cancel_var;
 extern enum gomp_target_offload_t gomp_target_offload_var;
 extern int gomp_max_task_priority_var;
 extern unsigned long long gomp_spin_count_var, gomp_throttled_spin_count_var;
+extern unsigned long gomp_thread_idle_time_var;
 extern unsigned long gomp_available_cpus, gomp_managed_threads;
 extern unsigned long *gomp_nthreads_var_list, gomp_nthreads_var_list_len;
 extern char *gomp_bind_var_list;
@@ -500,6 +513,8 @@ extern unsigned int gomp_num_teams_var;
 extern int gomp_nteams_var;
 extern int gomp_teams_thread_limit_var;
 extern int gomp_debug_var;
+extern bool gomp_wait_stats_var;
+extern unsigned long gomp_host_offload_var;
 extern bool gomp_display_affinity_var;
 extern char *gomp_affinity_format_var;
 extern size_t gomp_affinity_format_len;
@@ -1309,6 +1324,9 @@ extern bool gomp_work_share_start (size_t);
 extern void gomp_work_share_end (void);
 extern bool gomp_work_share_end_cancel (void);
 extern void gomp_work_share_end_nowait (void);
+extern enum gomp_schedule_type gomp_auto_sched_start (struct gomp_work_share *,
+						      void *, unsigned);
+extern void gomp_auto_sched_end (struct gomp_work_share *, unsigned);
 
 static inline void
 gomp_work_share_init_done (void)
@@ -1318,6 +1336,38 @@ gomp_work_share_init_done (void)
     gomp_ptrlock_set (&thr->ts.last_work_share->next_ws, thr->ts.work_share);
 }
 
+/* wait-stats.c */
+
+enum gomp_wait_kind
+{
+  GOMP_WAIT_BARRIER,
+  GOMP_WAIT_TASKWAIT,
+  GOMP_WAIT_TASKGROUP,
+  GOMP_WAIT_MUTEX,
+  GOMP_WAIT_KINDS
+};
+
+extern unsigned long long gomp_wait_stats_now (void);
+extern void gomp_wait_stats_record (enum gomp_wait_kind, unsigned long long);
+
+/* Return the start time of a wait to pass to gomp_wait_stats_end, or 0
+   if GOMP_WAIT_STATS is not enabled.  */
+
+static inline unsigned long long
+gomp_wait_stats_begin (void)
+{
+  if (__builtin_expect (gomp_wait_stats_var, 0))
+    return gomp_wait_stats_now ();
+  return 0;
+}
+
+static inline void
+gomp_wait_stats_end (enum gomp_wait_kind kind, unsigned long long start)
+{
+  if (__builtin_expect (start != 0, 0))
+    gomp_wait_stats_record (kind, start);
+}
+
 #ifdef HAVE_ATTRIBUTE_VISIBILITY
 # pragma GCC visibility pop
 #endif
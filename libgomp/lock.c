@@ -31,7 +31,25 @@
 #include "libgomp.h"
 
 /* The internal gomp_mutex_t and the external non-recursive omp_lock_t
-   have the same form.  Re-use it.  */
+   have the same form.  Re-use it.  Targets may implement some of the
+   hints of omp_init_lock_with_hint with a different kind of lock in
+   the same storage by overriding the following.  */
+
+#ifndef OMP_LOCK_INIT_HINT
+#define OMP_LOCK_INIT_HINT(LOCK, HINT) gomp_mutex_init (LOCK)
+#define OMP_LOCK_SET(LOCK) gomp_mutex_lock (LOCK)
+#define OMP_LOCK_UNSET(LOCK) gomp_mutex_unlock (LOCK)
+#define OMP_LOCK_TEST(LOCK) omp_lock_test_default (LOCK)
+
+static inline int
+omp_lock_test_default (gomp_mutex_t *lock)
+{
+  int oldval = 0;
+
+  return __atomic_compare_exchange_n (lock, &oldval, 1, false,
+				      MEMMODEL_ACQUIRE, MEMMODEL_RELAXED);
+}
+#endif
 
 void
 gomp_init_lock_30 (omp_lock_t *lock)
@@ -39,6 +57,13 @@ gomp_init_lock_30 (omp_lock_t *lock)
   gomp_mutex_init (lock);
 }
 
+void
+omp_init_lock_with_hint (omp_lock_t *lock,
+			 omp_sync_hint_t hint __attribute__((unused)))
+{
+  OMP_LOCK_INIT_HINT (lock, hint);
+}
+
 void
 gomp_destroy_lock_30 (omp_lock_t *lock)
 {
@@ -48,22 +73,19 @@ gomp_destroy_lock_30 (omp_lock_t *lock)
 void
 gomp_set_lock_30 (omp_lock_t *lock)
 {
-  gomp_mutex_lock (lock);
+  OMP_LOCK_SET (lock);
 }
 
 void
 gomp_unset_lock_30 (omp_lock_t *lock)
 {
-  gomp_mutex_unlock (lock);
+  OMP_LOCK_UNSET (lock);
 }
 
 int
 gomp_test_lock_30 (omp_lock_t *lock)
 {
-  int oldval = 0;
-
-  return __atomic_compare_exchange_n (lock, &oldval, 1, false,
-				      MEMMODEL_ACQUIRE, MEMMODEL_RELAXED);
+  return OMP_LOCK_TEST (lock);
 }
 
 void
@@ -72,6 +94,14 @@ gomp_init_nest_lock_30 (omp_nest_lock_t *lock)
   memset (lock, '\0', sizeof (*lock));
 }
 
+void
+omp_init_nest_lock_with_hint (omp_nest_lock_t *lock,
+			      omp_sync_hint_t hint __attribute__((unused)))
+{
+  memset (lock, '\0', sizeof (*lock));
+  OMP_LOCK_INIT_HINT (&lock->lock, hint);
+}
+
 void
 gomp_destroy_nest_lock_30 (omp_nest_lock_t *lock)
 {
@@ -84,7 +114,7 @@ gomp_set_nest_lock_30 (omp_nest_lock_t *lock)
 
   if (lock->owner != me)
     {
-      gomp_mutex_lock (&lock->lock);
+      OMP_LOCK_SET (&lock->lock);
       lock->owner = me;
     }
 
@@ -97,7 +127,7 @@ gomp_unset_nest_lock_30 (omp_nest_lock_t *lock)
   if (--lock->count == 0)
     {
       lock->owner = NULL;
-      gomp_mutex_unlock (&lock->lock);
+      OMP_LOCK_UNSET (&lock->lock);
     }
 }
 
@@ -105,14 +135,11 @@ int
 gomp_test_nest_lock_30 (omp_nest_lock_t *lock)
 {
   void *me = gomp_icv (true);
-  int oldval;
 
   if (lock->owner == me)
     return ++lock->count;
 
-  oldval = 0;
-  if (__atomic_compare_exchange_n (&lock->lock, &oldval, 1, false,
-				   MEMMODEL_ACQUIRE, MEMMODEL_RELAXED))
+  if (OMP_LOCK_TEST (&lock->lock))
     {
       lock->owner = me;
       lock->count = 1;
@@ -173,6 +173,30 @@ gomp_loop_guided_start (long start, long end, long incr, long chunk_size,
   return ret;
 }
 
+/* For schedule(auto), choose between static and guided scheduling based
+   on the previous invocations of the loop at call site SITE.  */
+
+static bool
+gomp_loop_auto_start (long start, long end, long incr, void *site,
+		      long *istart, long *iend)
+{
+  struct gomp_thread *thr = gomp_thread ();
+
+  thr->ts.static_trip = 0;
+  if (gomp_work_share_start (0))
+    {
+      struct gomp_team *team = thr->ts.team;
+      enum gomp_schedule_type sched
+	= gomp_auto_sched_start (thr->ts.work_share, site,
+				 team ? team->nthreads : 1);
+      gomp_loop_init (thr->ts.work_share, start, end, incr,
+		      sched, sched == GFS_GUIDED);
+      gomp_work_share_init_done ();
+    }
+
+  return ialias_call (GOMP_loop_runtime_next) (istart, iend);
+}
+
 bool
 GOMP_loop_runtime_start (long start, long end, long incr,
 			 long *istart, long *iend)
@@ -193,16 +217,21 @@ GOMP_loop_runtime_start (long start, long end, long incr,
 				     icv->run_sched_chunk_size,
 				     istart, iend);
     case GFS_AUTO:
-      /* For now map to schedule(static), later on we could play with feedback
-	 driven choice.  */
-      return gomp_loop_static_start (start, end, incr, 0, istart, iend);
+      return gomp_loop_auto_start (start, end, incr,
+				   __builtin_return_address (0),
+				   istart, iend);
     default:
       abort ();
     }
 }
 
+/* Resolve the schedule SCHED and *CHUNK_SIZE of a loop whose work share
+   is being initialized by the current thread.  If SITE is non-NULL,
+   schedule(auto) is resolved based on previous invocations of the loop
+   at that call site, otherwise it is treated as schedule(static).  */
+
 static long
-gomp_adjust_sched (long sched, long *chunk_size)
+gomp_adjust_sched (long sched, long *chunk_size, void *site)
 {
   sched &= ~GFS_MONOTONIC;
   switch (sched)
@@ -230,6 +259,15 @@ gomp_adjust_sched (long sched, long *chunk_size)
 	    *chunk_size = icv->run_sched_chunk_size;
 	    break;
 	  case GFS_AUTO:
+	    if (site)
+	      {
+		struct gomp_thread *thr = gomp_thread ();
+		struct gomp_team *team = thr->ts.team;
+		sched = gomp_auto_sched_start (thr->ts.work_share, site,
+					       team ? team->nthreads : 1);
+		*chunk_size = sched == GFS_GUIDED;
+		break;
+	      }
 	    sched = GFS_STATIC;
 	    *chunk_size = 0;
 	    break;
@@ -255,7 +293,8 @@ GOMP_loop_start (long start, long end, long incr, long sched,
     gomp_workshare_taskgroup_start ();
   if (gomp_work_share_start (0))
     {
-      sched = gomp_adjust_sched (sched, &chunk_size);
+      sched = gomp_adjust_sched (sched, &chunk_size,
+				 __builtin_return_address (0));
       gomp_loop_init (thr->ts.work_share, start, end, incr,
 		      sched, chunk_size);
       if (reductions)
@@ -425,7 +464,7 @@ GOMP_loop_ordered_start (long start, long end, long incr, long sched,
     ordered += (uintptr_t) *mem;
   if (gomp_work_share_start (ordered))
     {
-      sched = gomp_adjust_sched (sched, &chunk_size);
+      sched = gomp_adjust_sched (sched, &chunk_size, NULL);
       gomp_loop_init (thr->ts.work_share, start, end, incr,
 		      sched, chunk_size);
       if (reductions)
@@ -604,7 +643,7 @@ GOMP_loop_doacross_start (unsigned ncounts, long *counts, long sched,
       size_t extra = 0;
       if (mem)
 	extra = (uintptr_t) *mem;
-      sched = gomp_adjust_sched (sched, &chunk_size);
+      sched = gomp_adjust_sched (sched, &chunk_size, NULL);
       gomp_loop_init (thr->ts.work_share, 0, counts[0], 1,
 		      sched, chunk_size);
       gomp_doacross_init (ncounts, counts, chunk_size, extra);
@@ -793,6 +832,13 @@ gomp_parallel_loop_start (void (*fn) (void *), void *data,
 
   num_threads = gomp_resolve_num_threads (num_threads, 0);
   team = gomp_new_team (num_threads);
+  /* For schedule(auto), the outlined function identifies the loop.  */
+  if (sched == GFS_AUTO)
+    {
+      sched = gomp_auto_sched_start (&team->work_shares[0], (void *) fn,
+				     num_threads);
+      chunk_size = sched == GFS_GUIDED;
+    }
   gomp_loop_init (&team->work_shares[0], start, end, incr, sched, chunk_size);
   gomp_team_start (fn, data, num_threads, flags, team, NULL);
 }
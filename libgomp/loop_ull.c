@@ -170,6 +170,31 @@ gomp_loop_ull_guided_start (bool up, gomp_ull start, gomp_ull end,
   return ret;
 }
 
+/* For schedule(auto), choose between static and guided scheduling based
+   on the previous invocations of the loop at call site SITE.  */
+
+static bool
+gomp_loop_ull_auto_start (bool up, gomp_ull start, gomp_ull end,
+			  gomp_ull incr, void *site, gomp_ull *istart,
+			  gomp_ull *iend)
+{
+  struct gomp_thread *thr = gomp_thread ();
+
+  thr->ts.static_trip = 0;
+  if (gomp_work_share_start (0))
+    {
+      struct gomp_team *team = thr->ts.team;
+      enum gomp_schedule_type sched
+	= gomp_auto_sched_start (thr->ts.work_share, site,
+				 team ? team->nthreads : 1);
+      gomp_loop_ull_init (thr->ts.work_share, up, start, end, incr,
+			  sched, sched == GFS_GUIDED);
+      gomp_work_share_init_done ();
+    }
+
+  return ialias_call (GOMP_loop_ull_runtime_next) (istart, iend);
+}
+
 bool
 GOMP_loop_ull_runtime_start (bool up, gomp_ull start, gomp_ull end,
 			     gomp_ull incr, gomp_ull *istart, gomp_ull *iend)
@@ -190,17 +215,21 @@ GOMP_loop_ull_runtime_start (bool up, gomp_ull start, gomp_ull end,
 					 icv->run_sched_chunk_size,
 					 istart, iend);
     case GFS_AUTO:
-      /* For now map to schedule(static), later on we could play with feedback
-	 driven choice.  */
-      return gomp_loop_ull_static_start (up, start, end, incr,
-					 0, istart, iend);
+      return gomp_loop_ull_auto_start (up, start, end, incr,
+				       __builtin_return_address (0),
+				       istart, iend);
     default:
       abort ();
     }
 }
 
+/* Resolve the schedule SCHED and *CHUNK_SIZE of a loop whose work share
+   is being initialized by the current thread.  If SITE is non-NULL,
+   schedule(auto) is resolved based on previous invocations of the loop
+   at that call site, otherwise it is treated as schedule(static).  */
+
 static long
-gomp_adjust_sched (long sched, gomp_ull *chunk_size)
+gomp_adjust_sched (long sched, gomp_ull *chunk_size, void *site)
 {
   sched &= ~GFS_MONOTONIC;
   switch (sched)
@@ -228,6 +257,15 @@ gomp_adjust_sched (long sched, gomp_ull *chunk_size)
 	    *chunk_size = icv->run_sched_chunk_size;
 	    break;
 	  case GFS_AUTO:
+	    if (site)
+	      {
+		struct gomp_thread *thr = gomp_thread ();
+		struct gomp_team *team = thr->ts.team;
+		sched = gomp_auto_sched_start (thr->ts.work_share, site,
+					       team ? team->nthreads : 1);
+		*chunk_size = sched == GFS_GUIDED;
+		break;
+	      }
 	    sched = GFS_STATIC;
 	    *chunk_size = 0;
 	    break;
@@ -254,7 +292,8 @@ GOMP_loop_ull_start (bool up, gomp_ull start, gomp_ull end,
     gomp_workshare_taskgroup_start ();
   if (gomp_work_share_start (0))
     {
-      sched = gomp_adjust_sched (sched, &chunk_size);
+      sched = gomp_adjust_sched (sched, &chunk_size,
+				 __builtin_return_address (0));
       gomp_loop_ull_init (thr->ts.work_share, up, start, end, incr,
       			  sched, chunk_size);
       if (reductions)
@@ -427,7 +466,7 @@ GOMP_loop_ull_ordered_start (bool up, gomp_ull start, gomp_ull end,
     ordered += (uintptr_t) *mem;
   if (gomp_work_share_start (ordered))
     {
-      sched = gomp_adjust_sched (sched, &chunk_size);
+      sched = gomp_adjust_sched (sched, &chunk_size, NULL);
       gomp_loop_ull_init (thr->ts.work_share, up, start, end, incr,
 			  sched, chunk_size);
       if (reductions)
@@ -610,7 +649,7 @@ GOMP_loop_ull_doacross_start (unsigned ncounts, gomp_ull *counts,
       size_t extra = 0;
       if (mem)
 	extra = (uintptr_t) *mem;
-      sched = gomp_adjust_sched (sched, &chunk_size);
+      sched = gomp_adjust_sched (sched, &chunk_size, NULL);
       gomp_loop_ull_init (thr->ts.work_share, true, 0, counts[0], 1,
 			  sched, chunk_size);
       gomp_doacross_ull_init (ncounts, counts, chunk_size, extra);
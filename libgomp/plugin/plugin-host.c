@@ -0,0 +1,312 @@
+/* Plugin for OpenMP offloading to simulated devices on the host.
+
+   Copyright (C) 2022 Free Software Foundation, Inc.
+
+   This file is part of the GNU Offloading and Multi Processing Library
+   (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* Each device provided by this plugin has its own memory, which is
+   allocated from the host heap, so data has to be mapped to and from it
+   exactly as for a discrete accelerator.  Target regions execute the
+   host version of their code on a thread dedicated to the device, which
+   acts as the initial thread of the device and starts its own teams for
+   any parallel constructs in the region.  Asynchronous target regions
+   are queued to that thread, so they overlap with the host threads.
+
+   The devices are only provided if GOMP_HOST_OFFLOAD is set to their
+   number.  */
+
+#include "config.h"
+#include "libgomp-plugin.h"
+#include "gomp-constants.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/* A target region queued for execution on a device.  */
+
+struct host_job
+{
+  void (*fn) (void *);
+  void *vars;
+  /* Argument of GOMP_PLUGIN_target_task_completion for asynchronous
+     regions, NULL for synchronous ones.  */
+  void *async_data;
+  /* Set once a synchronous region has finished.  */
+  bool done;
+  struct host_job *next;
+};
+
+struct host_device
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  /* Signalled when a job is queued or the device is being shut down.  */
+  pthread_cond_t queue_cond;
+  /* Signalled when a synchronous job has finished.  */
+  pthread_cond_t done_cond;
+  struct host_job *head;
+  struct host_job **tail;
+  bool shutdown;
+};
+
+static int host_num_devices = -1;
+static struct host_device *host_devices;
+
+/* Execute the target regions queued for device DEV until it is shut
+   down.  */
+
+static void *
+host_device_thread (void *arg)
+{
+  struct host_device *dev = (struct host_device *) arg;
+
+  pthread_mutex_lock (&dev->lock);
+  while (true)
+    {
+      struct host_job *job = dev->head;
+      if (job == NULL)
+	{
+	  if (dev->shutdown)
+	    break;
+	  pthread_cond_wait (&dev->queue_cond, &dev->lock);
+	  continue;
+	}
+      dev->head = job->next;
+      if (dev->head == NULL)
+	dev->tail = &dev->head;
+      pthread_mutex_unlock (&dev->lock);
+
+      job->fn (job->vars);
+
+      if (job->async_data)
+	{
+	  GOMP_PLUGIN_target_task_completion (job->async_data);
+	  free (job);
+	  pthread_mutex_lock (&dev->lock);
+	}
+      else
+	{
+	  pthread_mutex_lock (&dev->lock);
+	  job->done = true;
+	  pthread_cond_broadcast (&dev->done_cond);
+	}
+    }
+  pthread_mutex_unlock (&dev->lock);
+  return NULL;
+}
+
+/* Queue JOB for execution on device DEV.  */
+
+static void
+host_queue_job (struct host_device *dev, struct host_job *job)
+{
+  job->next = NULL;
+  *dev->tail = job;
+  dev->tail = &job->next;
+  pthread_cond_signal (&dev->queue_cond);
+}
+
+const char *
+GOMP_OFFLOAD_get_name (void)
+{
+  return "host";
+}
+
+unsigned int
+GOMP_OFFLOAD_get_caps (void)
+{
+  return GOMP_OFFLOAD_CAP_OPENMP_400 | GOMP_OFFLOAD_CAP_NATIVE_EXEC;
+}
+
+int
+GOMP_OFFLOAD_get_type (void)
+{
+  return OFFLOAD_TARGET_TYPE_HOST;
+}
+
+unsigned
+GOMP_OFFLOAD_version (void)
+{
+  return GOMP_VERSION;
+}
+
+/* Return the number of devices requested by GOMP_HOST_OFFLOAD.  */
+
+int
+GOMP_OFFLOAD_get_num_devices (void)
+{
+  if (host_num_devices < 0)
+    {
+      unsigned long num = GOMP_PLUGIN_host_offload_devices ();
+      if (num > 64)
+	num = 0;
+      if (num)
+	host_devices
+	  = GOMP_PLUGIN_malloc_cleared (num * sizeof (*host_devices));
+      host_num_devices = num;
+    }
+  return host_num_devices;
+}
+
+bool
+GOMP_OFFLOAD_init_device (int n)
+{
+  struct host_device *dev = &host_devices[n];
+
+  pthread_mutex_init (&dev->lock, NULL);
+  pthread_cond_init (&dev->queue_cond, NULL);
+  pthread_cond_init (&dev->done_cond, NULL);
+  dev->head = NULL;
+  dev->tail = &dev->head;
+  dev->shutdown = false;
+  if (pthread_create (&dev->thread, NULL, host_device_thread, dev) != 0)
+    {
+      GOMP_PLUGIN_error ("cannot create thread for host device %d", n);
+      return false;
+    }
+  return true;
+}
+
+/* Wait for the target regions queued on device N to finish and stop its
+   thread.  */
+
+bool
+GOMP_OFFLOAD_fini_device (int n)
+{
+  struct host_device *dev = &host_devices[n];
+
+  pthread_mutex_lock (&dev->lock);
+  dev->shutdown = true;
+  pthread_cond_signal (&dev->queue_cond);
+  pthread_mutex_unlock (&dev->lock);
+  pthread_join (dev->thread, NULL);
+  pthread_cond_destroy (&dev->done_cond);
+  pthread_cond_destroy (&dev->queue_cond);
+  pthread_mutex_destroy (&dev->lock);
+  return true;
+}
+
+/* Target regions run the host code, so there is never an image for these
+   devices.  */
+
+int
+GOMP_OFFLOAD_load_image (int n __attribute__ ((unused)),
+			 unsigned version __attribute__ ((unused)),
+			 const void *target_data __attribute__ ((unused)),
+			 struct addr_pair **target_table)
+{
+  *target_table = NULL;
+  return 0;
+}
+
+bool
+GOMP_OFFLOAD_unload_image (int n __attribute__ ((unused)),
+			   unsigned version __attribute__ ((unused)),
+			   const void *target_data __attribute__ ((unused)))
+{
+  return true;
+}
+
+void *
+GOMP_OFFLOAD_alloc (int n __attribute__ ((unused)), size_t size)
+{
+  void *ret = malloc (size ? size : 1);
+  if (ret == NULL)
+    GOMP_PLUGIN_error ("cannot allocate %lu bytes of host device memory",
+		       (unsigned long) size);
+  return ret;
+}
+
+bool
+GOMP_OFFLOAD_free (int n __attribute__ ((unused)), void *ptr)
+{
+  free (ptr);
+  return true;
+}
+
+bool
+GOMP_OFFLOAD_dev2host (int n __attribute__ ((unused)), void *dst,
+		       const void *src, size_t size)
+{
+  memcpy (dst, src, size);
+  return true;
+}
+
+bool
+GOMP_OFFLOAD_host2dev (int n __attribute__ ((unused)), void *dst,
+		       const void *src, size_t size)
+{
+  memcpy (dst, src, size);
+  return true;
+}
+
+bool
+GOMP_OFFLOAD_dev2dev (int n __attribute__ ((unused)), void *dst,
+		      const void *src, size_t size)
+{
+  memmove (dst, src, size);
+  return true;
+}
+
+/* Run FN_PTR with the device address of the mapped variables VARS on
+   device N and wait for it to finish.  */
+
+void
+GOMP_OFFLOAD_run (int n, void *fn_ptr, void *vars,
+		  void **args __attribute__ ((unused)))
+{
+  struct host_device *dev = &host_devices[n];
+  struct host_job job;
+
+  job.fn = (void (*) (void *)) fn_ptr;
+  job.vars = vars;
+  job.async_data = NULL;
+  job.done = false;
+  pthread_mutex_lock (&dev->lock);
+  host_queue_job (dev, &job);
+  while (!job.done)
+    pthread_cond_wait (&dev->done_cond, &dev->lock);
+  pthread_mutex_unlock (&dev->lock);
+}
+
+/* Like GOMP_OFFLOAD_run, but return right away and call
+   GOMP_PLUGIN_target_task_completion with ASYNC_DATA once the region
+   has finished.  */
+
+void
+GOMP_OFFLOAD_async_run (int n, void *tgt_fn, void *tgt_vars,
+			void **args __attribute__ ((unused)),
+			void *async_data)
+{
+  struct host_device *dev = &host_devices[n];
+  struct host_job *job = GOMP_PLUGIN_malloc (sizeof (*job));
+
+  job->fn = (void (*) (void *)) tgt_fn;
+  job->vars = tgt_vars;
+  job->async_data = async_data;
+  job->done = false;
+  pthread_mutex_lock (&dev->lock);
+  host_queue_job (dev, job);
+  pthread_mutex_unlock (&dev->lock);
+}
@@ -3847,6 +3847,9 @@ gomp_target_init (void)
     return;
 
   cur = OFFLOAD_PLUGINS;
+  /* The host offload plugin is only used on request.  */
+  if (gomp_host_offload_var)
+    cur = *OFFLOAD_PLUGINS ? OFFLOAD_PLUGINS ",host" : "host";
   if (*cur)
     do
       {
@@ -160,17 +160,15 @@ gomp_clear_parent (struct priority_queue *q)
 
 /* Helper function for GOMP_task and gomp_create_target_task.
 
-   For a TASK with in/out dependencies, fill in the various dependency
-   queues.  PARENT is the parent of said task.  DEPEND is as in
-   GOMP_task.  */
+   Fill in the depend array of TASK from DEPEND, which is as in GOMP_task.
+   This doesn't look at any shared state, so is called before
+   team->task_lock is taken.  */
 
 static void
-gomp_task_handle_depend (struct gomp_task *task, struct gomp_task *parent,
-			 void **depend)
+gomp_task_init_depend (struct gomp_task *task, void **depend)
 {
   size_t ndepend = (uintptr_t) depend[0];
   size_t i;
-  hash_entry_type ent;
 
   if (ndepend)
     {
@@ -228,8 +226,6 @@ gomp_task_handle_depend (struct gomp_task *task, struct gomp_task *parent,
     }
   task->depend_count = ndepend;
   task->num_dependees = 0;
-  if (parent->depend_hash == NULL)
-    parent->depend_hash = htab_create (2 * ndepend > 12 ? 2 * ndepend : 12);
   for (i = 0; i < ndepend; i++)
     {
       task->depend[i].next = NULL;
@@ -237,68 +233,127 @@ gomp_task_handle_depend (struct gomp_task *task, struct gomp_task *parent,
       task->depend[i].task = task;
       task->depend[i].redundant = false;
       task->depend[i].redundant_out = false;
+    }
+}
+
+/* Record that TASK depends on the earlier sibling TSK.  */
 
+static inline void
+gomp_task_add_depender (struct gomp_task *task, struct gomp_task *tsk)
+{
+  if (tsk->dependers == NULL)
+    {
+      tsk->dependers
+	= gomp_malloc (sizeof (struct gomp_dependers_vec)
+		       + 6 * sizeof (struct gomp_task *));
+      tsk->dependers->n_elem = 1;
+      tsk->dependers->allocated = 6;
+      tsk->dependers->elem[0] = task;
+      task->num_dependees++;
+      return;
+    }
+  /* We already have some other dependency on tsk from earlier
+     depend clause.  */
+  else if (tsk->dependers->n_elem
+	   && (tsk->dependers->elem[tsk->dependers->n_elem - 1] == task))
+    return;
+  else if (tsk->dependers->n_elem == tsk->dependers->allocated)
+    {
+      tsk->dependers->allocated = tsk->dependers->allocated * 2 + 2;
+      tsk->dependers
+	= gomp_realloc (tsk->dependers,
+			sizeof (struct gomp_dependers_vec)
+			+ (tsk->dependers->allocated
+			   * sizeof (struct gomp_task *)));
+    }
+  tsk->dependers->elem[tsk->dependers->n_elem++] = task;
+  task->num_dependees++;
+}
+
+/* Helper function for GOMP_task and gomp_create_target_task.
+
+   For a TASK with in/out dependencies, whose depend array has been
+   filled in by gomp_task_init_depend, fill in the various dependency
+   queues.  PARENT is the parent of said task.  Called with
+   team->task_lock held.
+
+   Each hash table chain starts with the last depend({,in}out:) entry
+   for the address if it has not been superseded by a later one, followed
+   by the depend(in:) entries, followed by redundant_out entries.
+   depend(in:) entries are inserted after a leading depend({,in}out:)
+   entry, so that a depend(in:) only has to look at the head of the
+   chain, rather than walk all the earlier depend(in:) entries.  */
+
+static void
+gomp_task_handle_depend (struct gomp_task *task, struct gomp_task *parent)
+{
+  size_t ndepend = task->depend_count;
+  size_t i;
+  hash_entry_type ent;
+
+  if (parent->depend_hash == NULL)
+    parent->depend_hash = htab_create (2 * ndepend > 12 ? 2 * ndepend : 12);
+  for (i = 0; i < ndepend; i++)
+    {
       hash_entry_type *slot = htab_find_slot (&parent->depend_hash,
 					      &task->depend[i], INSERT);
       hash_entry_type out = NULL, last = NULL;
-      if (*slot)
+      if (*slot == NULL)
 	{
-	  /* If multiple depends on the same task are the same, all but the
-	     first one are redundant.  As inout/out come first, if any of them
-	     is inout/out, it will win, which is the right semantics.  */
-	  if ((*slot)->task == task)
+	  *slot = &task->depend[i];
+	  continue;
+	}
+
+      ent = *slot;
+      bool head_out = !ent->is_in && !ent->redundant_out;
+
+      /* If multiple depends on the same task are the same, all but the
+	 first one are redundant.  As inout/out come first, if any of them
+	 is inout/out, it will win, which is the right semantics.  A
+	 depend(in:) of this task has been put right after the leading
+	 depend({,in}out:) entry if there is one.  */
+      if (ent->task == task
+	  || (head_out && ent->next && ent->next->task == task))
+	{
+	  task->depend[i].redundant = true;
+	  continue;
+	}
+
+      if (task->depend[i].is_in)
+	{
+	  /* depend(in:...) doesn't depend on earlier depend(in:...), and
+	     only the leading entry can be a depend({,in}out:) that is not
+	     redundant_out.  */
+	  if (!head_out)
 	    {
-	      task->depend[i].redundant = true;
+	      task->depend[i].next = ent;
+	      ent->prev = &task->depend[i];
+	      *slot = &task->depend[i];
 	      continue;
 	    }
-	  for (ent = *slot; ent; ent = ent->next)
-	    {
-	      if (ent->redundant_out)
-		break;
+	  gomp_task_add_depender (task, ent->task);
+	  task->depend[i].prev = ent;
+	  task->depend[i].next = ent->next;
+	  if (ent->next)
+	    ent->next->prev = &task->depend[i];
+	  ent->next = &task->depend[i];
+	  continue;
+	}
 
-	      last = ent;
+      for (; ent; ent = ent->next)
+	{
+	  if (ent->redundant_out)
+	    break;
 
-	      /* depend(in:...) doesn't depend on earlier depend(in:...).  */
-	      if (task->depend[i].is_in && ent->is_in)
-		continue;
+	  last = ent;
 
-	      if (!ent->is_in)
-		out = ent;
+	  if (!ent->is_in)
+	    out = ent;
 
-	      struct gomp_task *tsk = ent->task;
-	      if (tsk->dependers == NULL)
-		{
-		  tsk->dependers
-		    = gomp_malloc (sizeof (struct gomp_dependers_vec)
-				   + 6 * sizeof (struct gomp_task *));
-		  tsk->dependers->n_elem = 1;
-		  tsk->dependers->allocated = 6;
-		  tsk->dependers->elem[0] = task;
-		  task->num_dependees++;
-		  continue;
-		}
-	      /* We already have some other dependency on tsk from earlier
-		 depend clause.  */
-	      else if (tsk->dependers->n_elem
-		       && (tsk->dependers->elem[tsk->dependers->n_elem - 1]
-			   == task))
-		continue;
-	      else if (tsk->dependers->n_elem == tsk->dependers->allocated)
-		{
-		  tsk->dependers->allocated
-		    = tsk->dependers->allocated * 2 + 2;
-		  tsk->dependers
-		    = gomp_realloc (tsk->dependers,
-				    sizeof (struct gomp_dependers_vec)
-				    + (tsk->dependers->allocated
-				       * sizeof (struct gomp_task *)));
-		}
-	      tsk->dependers->elem[tsk->dependers->n_elem++] = task;
-	      task->num_dependees++;
-	    }
-	  task->depend[i].next = *slot;
-	  (*slot)->prev = &task->depend[i];
+	  gomp_task_add_depender (task, ent->task);
 	}
+      task->depend[i].next = *slot;
+      (*slot)->prev = &task->depend[i];
       *slot = &task->depend[i];
 
       /* There is no need to store more than one depend({,in}out:) task per
@@ -312,7 +367,7 @@ gomp_task_handle_depend (struct gomp_task *task, struct gomp_task *parent,
 	 non-deferred tasks we want to see all outs, so they are moved to the
 	 end of the chain, after first redundant_out entry all following
 	 entries should be redundant_out.  */
-      if (!task->depend[i].is_in && out)
+      if (out)
 	{
 	  if (out != last)
 	    {
@@ -509,6 +564,8 @@ GOMP_task (void (*fn) (void *), void *data, void (*cpyfn) (void *, void *),
       task->fn = fn;
       task->fn_data = arg;
       task->final_task = (flags & GOMP_TASK_FLAG_FINAL) >> 1;
+      if (depend_size)
+	gomp_task_init_depend (task, depend);
       gomp_mutex_lock (&team->task_lock);
       /* If parallel or taskgroup has been cancelled, don't start new
 	 tasks.  */
@@ -537,7 +594,7 @@ GOMP_task (void (*fn) (void *), void *data, void (*cpyfn) (void *, void *),
 	taskgroup->num_children++;
       if (depend_size)
 	{
-	  gomp_task_handle_depend (task, parent, depend);
+	  gomp_task_handle_depend (task, parent);
 	  if (task->num_dependees)
 	    {
 	      /* Tasks that depend on other tasks are not put into the
@@ -838,6 +895,8 @@ gomp_create_target_task (struct gomp_device_descr *devicep,
   task->fn = NULL;
   task->fn_data = ttask;
   task->final_task = 0;
+  if (depend_size)
+    gomp_task_init_depend (task, depend);
   gomp_mutex_lock (&team->task_lock);
   /* If parallel or taskgroup has been cancelled, don't start new tasks.  */
   if (__builtin_expect (gomp_cancel_var, 0))
@@ -862,7 +921,7 @@ gomp_create_target_task (struct gomp_device_descr *devicep,
     }
   if (depend_size)
     {
-      gomp_task_handle_depend (task, parent, depend);
+      gomp_task_handle_depend (task, parent);
       if (task->num_dependees)
 	{
 	  if (taskgroup)
@@ -1622,7 +1681,11 @@ GOMP_taskwait (void)
 	  thr->task = task;
 	}
       else
-	gomp_sem_wait (&taskwait.taskwait_sem);
+	{
+	  unsigned long long wait_start = gomp_wait_stats_begin ();
+	  gomp_sem_wait (&taskwait.taskwait_sem);
+	  gomp_wait_stats_end (GOMP_WAIT_TASKWAIT, wait_start);
+	}
       gomp_mutex_lock (&team->task_lock);
       if (child_task)
 	{
@@ -1886,7 +1949,11 @@ gomp_task_maybe_wait_for_dependencies (void **depend)
 	  thr->task = task;
 	}
       else
-	gomp_sem_wait (&taskwait.taskwait_sem);
+	{
+	  unsigned long long wait_start = gomp_wait_stats_begin ();
+	  gomp_sem_wait (&taskwait.taskwait_sem);
+	  gomp_wait_stats_end (GOMP_WAIT_TASKWAIT, wait_start);
+	}
       gomp_mutex_lock (&team->task_lock);
       if (child_task)
 	{
@@ -2090,7 +2157,11 @@ GOMP_taskgroup_end (void)
 	  thr->task = task;
 	}
       else
-	gomp_sem_wait (&taskgroup->taskgroup_sem);
+	{
+	  unsigned long long wait_start = gomp_wait_stats_begin ();
+	  gomp_sem_wait (&taskgroup->taskgroup_sem);
+	  gomp_wait_stats_end (GOMP_WAIT_TASKGROUP, wait_start);
+	}
       gomp_mutex_lock (&team->task_lock);
       if (child_task)
 	{
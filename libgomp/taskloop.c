@@ -26,6 +26,138 @@
 /* This file handles the taskloop construct.  It is included twice, once
    for the long and once for unsigned long long variant.  */
 
+#ifdef TYPE_is_long
+#define gomp_taskloop_split gomp_taskloop_split_long
+#define gomp_taskloop_split_fn gomp_taskloop_split_fn_long
+#define gomp_taskloop_split_start gomp_taskloop_split_start_long
+#define gomp_taskloop_split_run gomp_taskloop_split_run_long
+#else
+#define gomp_taskloop_split gomp_taskloop_split_ull
+#define gomp_taskloop_split_fn gomp_taskloop_split_fn_ull
+#define gomp_taskloop_split_start gomp_taskloop_split_start_ull
+#define gomp_taskloop_split_run gomp_taskloop_split_run_ull
+#endif
+
+/* Description of the taskloop tasks with numbers FIRST up to but not
+   including LAST, used when the tasks are created by recursively
+   splitting the range of tasks instead of all at once by the
+   encountering thread.  The first NFIRST + 1 tasks cover TASK_STEP
+   and the remaining ones NFIRST_TASK_STEP iterations, exactly as if
+   they had been created eagerly.  */
+
+struct gomp_taskloop_split
+{
+  void (*fn) (void *);
+  void *data;
+  long arg_size;
+  long arg_align;
+  unsigned flags;
+  int priority;
+  TYPE start;
+  TYPE task_step;
+  TYPE nfirst_task_step;
+  unsigned long nfirst;
+  unsigned long first;
+  unsigned long last;
+};
+
+/* Return the first iteration of task number I described by S.  */
+
+static inline TYPE
+gomp_taskloop_split_start (struct gomp_taskloop_split *s, unsigned long i)
+{
+  UTYPE ret = (UTYPE) s->start;
+  if (i <= s->nfirst)
+    return (TYPE) (ret + (UTYPE) i * (UTYPE) s->task_step);
+  ret += (UTYPE) (s->nfirst + 1) * (UTYPE) s->task_step;
+  return (TYPE) (ret + (UTYPE) (i - s->nfirst - 1)
+			* (UTYPE) s->nfirst_task_step);
+}
+
+static void gomp_taskloop_split_fn (void *);
+
+/* Run the taskloop tasks described by S one after another, splitting
+   off the rest of the range on demand.  */
+
+static void
+gomp_taskloop_split_run (struct gomp_taskloop_split *s)
+{
+  struct gomp_thread *thr = gomp_thread ();
+  struct gomp_team *team = thr->ts.team;
+  struct gomp_task *parent = thr->task;
+  unsigned long i;
+
+  char buf[s->arg_size + s->arg_align - 1];
+  char *arg = (char *) (((uintptr_t) buf + s->arg_align - 1)
+			& ~(uintptr_t) (s->arg_align - 1));
+  for (i = s->first; i < s->last; i++)
+    {
+      struct gomp_task task;
+
+      /* Hand the upper half of the remaining tasks over to a new task
+	 whenever no other tasks are queued, so that idle threads find
+	 work, and otherwise keep going; ranges which nobody steals are
+	 thus never split.  */
+      if (s->last - i > 1
+	  && __atomic_load_n (&team->task_queued_count, MEMMODEL_RELAXED) == 0)
+	{
+	  struct gomp_taskloop_split half = *s;
+	  half.first = i + (s->last - i) / 2;
+	  s->last = half.first;
+	  GOMP_task (gomp_taskloop_split_fn, &half, NULL, sizeof (half),
+		     __alignof__ (half), true,
+		     (s->flags & GOMP_TASK_FLAG_UNTIED)
+		     | GOMP_TASK_FLAG_PRIORITY, NULL, s->priority, NULL);
+	}
+
+      /* If parallel or taskgroup has been cancelled, don't start new
+	 tasks.  */
+      if (__builtin_expect (gomp_cancel_var, 0))
+	{
+	  if (gomp_team_barrier_cancelled (&team->barrier))
+	    return;
+	  if (parent->taskgroup)
+	    {
+	      if (parent->taskgroup->cancelled)
+		return;
+	      if (parent->taskgroup->workshare
+		  && parent->taskgroup->prev
+		  && parent->taskgroup->prev->cancelled)
+		return;
+	    }
+	}
+
+      memcpy (arg, s->data, s->arg_size);
+      ((TYPE *)arg)[0] = gomp_taskloop_split_start (s, i);
+      ((TYPE *)arg)[1] = gomp_taskloop_split_start (s, i + 1);
+
+      /* Run each task as an undeferred child of the current one, so that
+	 a taskwait in its body does not wait for the tasks created
+	 above.  */
+      gomp_init_task (&task, parent, gomp_icv (false));
+      task.priority = s->priority;
+      task.kind = GOMP_TASK_UNDEFERRED;
+      task.final_task = (s->flags & GOMP_TASK_FLAG_FINAL) >> 1;
+      task.in_tied_task = parent->in_tied_task;
+      task.taskgroup = parent->taskgroup;
+      thr->task = &task;
+      s->fn (arg);
+      if (!priority_queue_empty_p (&task.children_queue, MEMMODEL_RELAXED))
+	{
+	  gomp_mutex_lock (&team->task_lock);
+	  gomp_clear_parent (&task.children_queue);
+	  gomp_mutex_unlock (&team->task_lock);
+	}
+      gomp_end_task ();
+    }
+}
+
+static void
+gomp_taskloop_split_fn (void *data)
+{
+  gomp_taskloop_split_run ((struct gomp_taskloop_split *) data);
+}
+
 /* Called when encountering an explicit task directive.  If IF_CLAUSE is
    false, then we must not delay in executing the task.  If UNTIED is true,
    then the task may be executed by any member of the team.  */
@@ -206,9 +338,41 @@ GOMP_taskloop (void (*fn) (void *), void *data, void (*cpyfn) (void *, void *),
   if (priority > gomp_max_task_priority_var)
     priority = gomp_max_task_priority_var;
 
-  if ((flags & GOMP_TASK_FLAG_IF) == 0 || team == NULL
-      || (thr->task && thr->task->final_task)
-      || team->task_count + num_tasks > 64 * team->nthreads)
+  /* When there are many more tasks than threads, don't create them all
+     here; instead run them, handing the upper half of the remaining
+     range to a new task, which splits it further in the same way,
+     whenever the other threads run out of work.  This also keeps the
+     number of queued tasks low enough that large taskloops are not
+     executed undeferred.  DATA stays
+     unchanged until GOMP_taskgroup_end returns, so the tasks may copy
+     it later, but not if copy constructors have to be run at this
+     point.  */
+  if ((flags & (GOMP_TASK_FLAG_IF | GOMP_TASK_FLAG_NOGROUP))
+      == GOMP_TASK_FLAG_IF
+      && cpyfn == NULL
+      && team != NULL
+      && team->nthreads > 1
+      && num_tasks > 8UL * team->nthreads
+      && !thr->task->final_task)
+    {
+      struct gomp_taskloop_split s;
+      s.fn = fn;
+      s.data = data;
+      s.arg_size = arg_size;
+      s.arg_align = arg_align;
+      s.flags = flags;
+      s.priority = priority;
+      s.start = start;
+      s.task_step = task_step;
+      s.nfirst_task_step = nfirst_task_step;
+      s.nfirst = nfirst;
+      s.first = 0;
+      s.last = num_tasks;
+      gomp_taskloop_split_run (&s);
+    }
+  else if ((flags & GOMP_TASK_FLAG_IF) == 0 || team == NULL
+	   || (thr->task && thr->task->final_task)
+	   || team->task_count + num_tasks > 64 * team->nthreads)
     {
       unsigned long i;
       if (__builtin_expect (cpyfn != NULL, 0))
@@ -398,3 +562,8 @@ GOMP_taskloop (void (*fn) (void *), void *data, void (*cpyfn) (void *, void *),
   if ((flags & GOMP_TASK_FLAG_NOGROUP) == 0)
     ialias_call (GOMP_taskgroup_end) ();
 }
+
+#undef gomp_taskloop_split
+#undef gomp_taskloop_split_fn
+#undef gomp_taskloop_split_start
+#undef gomp_taskloop_split_run
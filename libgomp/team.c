@@ -30,6 +30,11 @@
 #include "pool.h"
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <time.h>
+#if !defined HAVE_CLOCK_GETTIME && defined HAVE_SYS_TIME_H
+# include <sys/time.h>
+#endif
 
 #ifdef LIBGOMP_USE_PTHREADS
 pthread_attr_t gomp_thread_attr;
@@ -63,6 +68,152 @@ struct gomp_thread_start_data
 };
 
 
+/* Threads of nested teams don't belong to any thread pool.  Instead of
+   exiting when their team ends, they wait up to GOMP_THREAD_IDLE_TIME
+   milliseconds on this list to be picked up by the next nested team,
+   started from any thread, so that nested parallel regions don't pay
+   for pthread_create every time.  */
+
+struct gomp_idle_thread
+{
+  struct gomp_idle_thread *next;
+  struct gomp_thread *thr;
+  pthread_t handle;
+  pthread_cond_t cond;
+  /* Set when THR has been handed a new team, or told to exit if
+     THR->fn is NULL.  */
+  bool claimed;
+  /* Set when THR is told to exit by a thread that will join it.  */
+  bool joined;
+};
+
+static pthread_mutex_t gomp_idle_threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct gomp_idle_thread *gomp_idle_threads;
+static bool gomp_idle_threads_closed;
+
+/* Wait on a monotonic clock if we can, so that setting the time of day
+   doesn't make idle threads linger or exit early.  */
+#if defined HAVE_PTHREAD_CONDATTR_SETCLOCK && defined HAVE_CLOCK_GETTIME \
+    && defined CLOCK_MONOTONIC
+# define GOMP_IDLE_THREAD_CLOCK CLOCK_MONOTONIC
+#endif
+
+/* Called by THR after its nested team has ended.  Return true if THR
+   has been given another team to run, false if it should exit.  In the
+   latter case, set *JOINED if THR will be joined and so must not detach
+   itself.  */
+
+static bool
+gomp_idle_thread_wait (struct gomp_thread *thr, bool *joined)
+{
+  struct gomp_idle_thread self, **p;
+  struct timespec deadline;
+  unsigned long ms = gomp_thread_idle_time_var;
+
+  if (ms == 0)
+    return false;
+
+#ifdef GOMP_IDLE_THREAD_CLOCK
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init (&cond_attr);
+  pthread_condattr_setclock (&cond_attr, GOMP_IDLE_THREAD_CLOCK);
+  pthread_cond_init (&self.cond, &cond_attr);
+  pthread_condattr_destroy (&cond_attr);
+  clock_gettime (GOMP_IDLE_THREAD_CLOCK, &deadline);
+#else
+  pthread_cond_init (&self.cond, NULL);
+# ifdef HAVE_CLOCK_GETTIME
+  clock_gettime (CLOCK_REALTIME, &deadline);
+# else
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  deadline.tv_sec = tv.tv_sec;
+  deadline.tv_nsec = tv.tv_usec * 1000;
+# endif
+#endif
+  self.thr = thr;
+  self.handle = pthread_self ();
+  self.claimed = false;
+  self.joined = false;
+  deadline.tv_sec += ms / 1000;
+  deadline.tv_nsec += (ms % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000)
+    {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000;
+    }
+
+  pthread_mutex_lock (&gomp_idle_threads_lock);
+  if (!gomp_idle_threads_closed)
+    {
+      self.next = gomp_idle_threads;
+      gomp_idle_threads = &self;
+      while (!self.claimed)
+	if (pthread_cond_timedwait (&self.cond, &gomp_idle_threads_lock,
+				    &deadline) == ETIMEDOUT
+	    && !self.claimed)
+	  {
+	    for (p = &gomp_idle_threads; *p != &self; p = &(*p)->next)
+	      ;
+	    *p = self.next;
+	    break;
+	  }
+    }
+  pthread_mutex_unlock (&gomp_idle_threads_lock);
+  pthread_cond_destroy (&self.cond);
+  *joined = self.joined;
+  return self.claimed && thr->fn != NULL;
+}
+
+/* Tell all idle threads to exit.  If CLOSE, no thread will become
+   idle afterwards, and wait for the idle threads to have exited, so
+   that none of them still runs our code once libgomp is unloaded.  */
+
+static void
+gomp_release_idle_threads (bool close)
+{
+  struct gomp_idle_thread *idle;
+  pthread_t *handles = NULL;
+  size_t n = 0;
+
+  pthread_mutex_lock (&gomp_idle_threads_lock);
+  if (close)
+    {
+      gomp_idle_threads_closed = true;
+      for (idle = gomp_idle_threads; idle; idle = idle->next)
+	n++;
+      if (n)
+	handles = gomp_malloc (n * sizeof (pthread_t));
+      n = 0;
+    }
+  for (idle = gomp_idle_threads; idle; idle = idle->next)
+    {
+      idle->thr->fn = NULL;
+      idle->claimed = true;
+      if (close)
+	{
+	  idle->joined = true;
+	  handles[n++] = idle->handle;
+	}
+      pthread_cond_signal (&idle->cond);
+    }
+  gomp_idle_threads = NULL;
+  pthread_mutex_unlock (&gomp_idle_threads_lock);
+
+  while (n)
+    pthread_join (handles[--n], NULL);
+  free (handles);
+}
+
+/* In the child after fork, the idle threads no longer exist.  */
+
+static void
+gomp_idle_threads_atfork_child (void)
+{
+  pthread_mutex_init (&gomp_idle_threads_lock, NULL);
+  gomp_idle_threads = NULL;
+}
+
 /* This function is a pthread_create entry point.  This contains the idle
    loop in which a thread waits to be called up to become part of a team.  */
 
@@ -74,6 +225,7 @@ gomp_thread_start (void *xdata)
   struct gomp_thread_pool *pool;
   void (*local_fn) (void *);
   void *local_data;
+  bool joined = false;
 
 #if defined HAVE_TLS || defined USE_EMUTLS
   thr = &gomp_tls_data;
@@ -106,15 +258,27 @@ gomp_thread_start (void *xdata)
 
   if (data->nested)
     {
-      struct gomp_team *team = thr->ts.team;
-      struct gomp_task *task = thr->task;
+      do
+	{
+	  struct gomp_team *team = thr->ts.team;
+	  struct gomp_task *task = thr->task;
 
-      gomp_barrier_wait (&team->barrier);
+	  gomp_barrier_wait (&team->barrier);
 
-      local_fn (local_data);
-      gomp_team_barrier_wait_final (&team->barrier);
-      gomp_finish_task (task);
-      gomp_barrier_wait_last (&team->barrier);
+	  local_fn (local_data);
+	  gomp_team_barrier_wait_final (&team->barrier);
+	  gomp_finish_task (task);
+	  gomp_barrier_wait_last (&team->barrier);
+
+	  local_fn = NULL;
+	  if (gomp_idle_thread_wait (thr, &joined))
+	    {
+	      local_fn = thr->fn;
+	      local_data = thr->data;
+	      thr->fn = NULL;
+	    }
+	}
+      while (local_fn);
     }
   else
     {
@@ -140,7 +304,8 @@ gomp_thread_start (void *xdata)
     }
 
   gomp_sem_destroy (&thr->release);
-  pthread_detach (pthread_self ());
+  if (!joined)
+    pthread_detach (pthread_self ());
   thr->thread_pool = NULL;
   thr->task = NULL;
   return NULL;
@@ -458,11 +623,12 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
   else
     bind = omp_proc_bind_false;
 
-  /* We only allow the reuse of idle threads for non-nested PARALLEL
-     regions.  This appears to be implied by the semantics of
+  /* We only allow the reuse of the threads of the pool for non-nested
+     PARALLEL regions.  This appears to be implied by the semantics of
      threadprivate variables, but perhaps that's reading too much into
      things.  Certainly it does prevent any locking problems, since
-     only the initial program thread will modify gomp_threads.  */
+     only the initial program thread will modify gomp_threads.  Nested
+     teams instead reuse idle threads of earlier nested teams below.  */
   if (!nested)
     {
       old_threads_used = pool->threads_used;
@@ -746,6 +912,53 @@ gomp_team_start (void (*fn) (void *), void *data, unsigned nthreads,
 #endif
     }
 
+  /* Pick up idle threads of earlier nested teams.  They are not bound
+     to any place, so don't use them if threads need to be placed.  */
+  if (nested
+      && gomp_places_list == NULL
+      && !gomp_display_affinity_var
+      && __atomic_load_n (&gomp_idle_threads, MEMMODEL_RELAXED) != NULL)
+    {
+      pthread_mutex_lock (&gomp_idle_threads_lock);
+      for (; i < nthreads && gomp_idle_threads != NULL; ++i)
+	{
+	  struct gomp_idle_thread *idle = gomp_idle_threads;
+	  gomp_idle_threads = idle->next;
+	  nthr = idle->thr;
+	  nthr->ts.team = team;
+	  nthr->ts.work_share = &team->work_shares[0];
+	  nthr->ts.last_work_share = NULL;
+	  nthr->ts.team_id = i;
+	  nthr->ts.level = team->prev_ts.level + 1;
+	  nthr->ts.active_level = thr->ts.active_level;
+	  nthr->ts.place_partition_off = thr->ts.place_partition_off;
+	  nthr->ts.place_partition_len = thr->ts.place_partition_len;
+	  nthr->ts.def_allocator = thr->ts.def_allocator;
+#ifdef HAVE_SYNC_BUILTINS
+	  nthr->ts.single_count = 0;
+#endif
+	  nthr->ts.static_trip = 0;
+	  nthr->num_teams = thr->num_teams;
+	  nthr->team_num = thr->team_num;
+	  nthr->task = &team->implicit_task[i];
+	  nthr->place = 0;
+	  nthr->thread_pool = pool;
+	  gomp_init_task (nthr->task, task, icv);
+	  team->implicit_task[i].icv.nthreads_var = nthreads_var;
+	  team->implicit_task[i].icv.bind_var = bind_var;
+	  nthr->task->taskgroup = taskgroup;
+	  nthr->fn = fn;
+	  nthr->data = data;
+	  team->ordered_release[i] = &nthr->release;
+	  idle->claimed = true;
+	  pthread_cond_signal (&idle->cond);
+	}
+      pthread_mutex_unlock (&gomp_idle_threads_lock);
+
+      if (i == nthreads)
+	goto do_release;
+    }
+
   attr = &gomp_thread_attr;
   if (__builtin_expect (gomp_places_list != NULL, 0))
     {
@@ -1029,11 +1242,14 @@ initialize_team (void)
 
   if (pthread_key_create (&gomp_thread_destructor, gomp_free_thread) != 0)
     gomp_fatal ("could not create thread pool destructor.");
+
+  pthread_atfork (NULL, NULL, gomp_idle_threads_atfork_child);
 }
 
 static void __attribute__((destructor))
 team_destructor (void)
 {
+  gomp_release_idle_threads (true);
   /* Without this dlclose on libgomp could lead to subsequent
      crashes.  */
   pthread_key_delete (gomp_thread_destructor);
@@ -1065,6 +1281,7 @@ gomp_pause_host (void)
   struct gomp_thread_pool *pool = thr->thread_pool;
   if (thr->ts.level)
     return -1;
+  gomp_release_idle_threads (false);
   if (pool)
     {
       if (pool->threads_used > 0)
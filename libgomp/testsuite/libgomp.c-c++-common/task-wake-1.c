@@ -0,0 +1,55 @@
+/* { dg-do run } */
+/* { dg-set-target-env-var OMP_WAIT_POLICY "passive" } */
+
+#include <omp.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Test that tasks created while the rest of the team is blocked in the
+   barrier wake it up.  The creating thread does not run the tasks
+   itself until they have all been started.  */
+
+int started, done;
+
+int
+main ()
+{
+  #pragma omp parallel num_threads (4)
+  #pragma omp single nowait
+  {
+    int nthreads = omp_get_num_threads ();
+    int i;
+
+    for (i = 0; i < 64; i++)
+      {
+	/* Give the other threads time to go to sleep.  */
+	if ((i & 15) == 0)
+	  usleep (10000);
+
+	#pragma omp task
+	{
+	  #pragma omp atomic
+	  started++;
+	  #pragma omp atomic
+	  done++;
+	}
+
+	/* Spin without reaching a task scheduling point, so someone
+	   else has to run the task.  */
+	if (nthreads > 1)
+	  {
+	    int s;
+	    do
+	      {
+		#pragma omp atomic read
+		s = started;
+	      }
+	    while (s != i + 1);
+	  }
+      }
+  }
+
+  if (done != 64)
+    abort ();
+  return 0;
+}
@@ -0,0 +1,67 @@
+/* { dg-do run } */
+/* { dg-options "-O2" } */
+/* { dg-set-target-env-var OMP_NUM_THREADS "4" } */
+
+/* Taskloops with many more tasks than threads, which libgomp splits
+   recursively.  */
+
+#define N 20000
+
+int a[N], b[64][64];
+
+int
+main ()
+{
+  int i, j, l = -1, s = 0;
+  unsigned long long k, m = 0;
+  long long t = 0;
+
+  #pragma omp parallel
+  #pragma omp single
+  {
+    #pragma omp taskloop grainsize (3) lastprivate (l) reduction (+:s)
+    for (i = 0; i < N; i++)
+      {
+	a[i]++;
+	s += i;
+	l = i;
+      }
+
+    #pragma omp taskloop grainsize (strict: 7) reduction (+:t)
+    for (i = N - 1; i >= 0; i -= 2)
+      {
+	a[i]++;
+	t += i;
+      }
+
+    #pragma omp taskloop num_tasks (500) collapse (2) lastprivate (k)
+    for (k = 0; k < 64; k++)
+      for (j = 0; j < 64; j++)
+	b[k][j] += (int) k * 64 + j;
+
+    #pragma omp taskloop grainsize (1) reduction (+:m)
+    for (k = 100; k > 0; k--)
+      {
+	int c = 0;
+	#pragma omp task shared (c)
+	c = 1;
+	#pragma omp taskwait
+	m += k * c;
+      }
+  }
+
+  for (i = 0; i < N; i++)
+    if (a[i] != 1 + (i & 1))
+      __builtin_abort ();
+  if (l != N - 1 || s != (N - 1) * (N / 2))
+    __builtin_abort ();
+  if (t != (long long) N * N / 4)
+    __builtin_abort ();
+  for (i = 0; i < 64; i++)
+    for (j = 0; j < 64; j++)
+      if (b[i][j] != i * 64 + j)
+	__builtin_abort ();
+  if (k != 64 || m != 5050)
+    __builtin_abort ();
+  return 0;
+}
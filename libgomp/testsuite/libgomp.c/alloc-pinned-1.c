@@ -0,0 +1,148 @@
+/* { dg-do run { target *-*-linux* } } */
+
+/* Test that pinned and partitioned allocators work, including realloc
+   between them and the default allocator.  */
+
+#include <omp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const omp_alloctrait_t pinned_traits[]
+= { { omp_atk_pinned, omp_atv_true },
+    { omp_atk_fallback, omp_atv_null_fb } };
+const omp_alloctrait_t pinned_fb_traits[]
+= { { omp_atk_pinned, omp_atv_true },
+    { omp_atk_alignment, 64 } };
+const omp_alloctrait_t interleaved_traits[]
+= { { omp_atk_partition, omp_atv_interleaved } };
+const omp_alloctrait_t nearest_traits[]
+= { { omp_atk_partition, omp_atv_nearest },
+    { omp_atk_pool_size, 1 << 20 } };
+
+/* Return the amount of locked memory in kB, or -1 if unknown.  */
+
+static long
+locked_kb (void)
+{
+  char line[256];
+  long ret = -1;
+  FILE *f = fopen ("/proc/self/status", "r");
+  if (f == NULL)
+    return -1;
+  while (fgets (line, sizeof (line), f))
+    if (strncmp (line, "VmLck:", 6) == 0)
+      {
+	ret = strtol (line + 6, NULL, 10);
+	break;
+      }
+  fclose (f);
+  return ret;
+}
+
+static void
+fill (char *p, size_t n, int seed)
+{
+  size_t i;
+  for (i = 0; i < n; i++)
+    p[i] = (char) (i * 7 + seed);
+}
+
+static void
+check (char *p, size_t n, int seed)
+{
+  size_t i;
+  for (i = 0; i < n; i++)
+    if (p[i] != (char) (i * 7 + seed))
+      abort ();
+}
+
+static void
+test_allocator (omp_allocator_handle_t a, size_t align)
+{
+  size_t sizes[] = { 16, 4000, 4096, 70000 };
+  size_t i;
+  for (i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+    {
+      char *p = (char *) omp_alloc (sizes[i], a);
+      char *q;
+      if (p == NULL || ((uintptr_t) p) % align != 0)
+	abort ();
+      fill (p, sizes[i], i);
+      q = (char *) omp_realloc (p, 2 * sizes[i], a, a);
+      if (q == NULL)
+	abort ();
+      check (q, sizes[i], i);
+      fill (q, 2 * sizes[i], i + 1);
+      p = (char *) omp_realloc (q, sizes[i] / 2, omp_default_mem_alloc, a);
+      if (p == NULL)
+	abort ();
+      check (p, sizes[i] / 2, i + 1);
+      q = (char *) omp_realloc (p, sizes[i], a, omp_default_mem_alloc);
+      if (q == NULL)
+	abort ();
+      check (q, sizes[i] / 2, i + 1);
+      omp_free (q, a);
+      p = (char *) omp_calloc (sizes[i], 1, a);
+      if (p == NULL)
+	abort ();
+      for (size_t j = 0; j < sizes[i]; j++)
+	if (p[j])
+	  abort ();
+      omp_free (p, a);
+    }
+}
+
+int
+main ()
+{
+  omp_allocator_handle_t a, b, c, d;
+  char *p;
+
+  a = omp_init_allocator (omp_default_mem_space, 2, pinned_traits);
+  b = omp_init_allocator (omp_default_mem_space, 2, pinned_fb_traits);
+  c = omp_init_allocator (omp_default_mem_space, 1, interleaved_traits);
+  d = omp_init_allocator (omp_default_mem_space, 2, nearest_traits);
+  if (a == omp_null_allocator || b == omp_null_allocator
+      || c == omp_null_allocator || d == omp_null_allocator)
+    abort ();
+
+  /* With the null fallback, a successful pinned allocation must be
+     locked in memory.  It may fail if RLIMIT_MEMLOCK is too low.  */
+  p = (char *) omp_alloc (8192, a);
+  if (p != NULL)
+    {
+      long kb = locked_kb ();
+      if (kb == 0)
+	abort ();
+      fill (p, 8192, 3);
+      check (p, 8192, 3);
+      omp_free (p, a);
+    }
+
+  /* With the default fallback, allocations must always succeed.  */
+  test_allocator (b, 64);
+  test_allocator (c, sizeof (void *));
+  test_allocator (d, sizeof (void *));
+
+  #pragma omp parallel num_threads (4)
+  {
+    char *q = (char *) omp_alloc (100000, c);
+    char *r = (char *) omp_alloc (10000, d);
+    if (q == NULL || r == NULL)
+      abort ();
+    fill (q, 100000, omp_get_thread_num ());
+    fill (r, 10000, omp_get_thread_num ());
+    check (q, 100000, omp_get_thread_num ());
+    check (r, 10000, omp_get_thread_num ());
+    omp_free (q, c);
+    omp_free (r, d);
+  }
+
+  omp_destroy_allocator (a);
+  omp_destroy_allocator (b);
+  omp_destroy_allocator (c);
+  omp_destroy_allocator (d);
+  return 0;
+}
@@ -0,0 +1,104 @@
+/* { dg-do run { target *-*-linux* } } */
+
+/* Test that small pinned allocations share locked pages rather than
+   getting one locked mapping each.  */
+
+#include <omp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N 1000
+
+const omp_alloctrait_t pinned_traits[]
+= { { omp_atk_pinned, omp_atv_true },
+    { omp_atk_fallback, omp_atv_null_fb } };
+
+/* Return the amount of locked memory in kB, or -1 if unknown.  */
+
+static long
+locked_kb (void)
+{
+  char line[256];
+  long ret = -1;
+  FILE *f = fopen ("/proc/self/status", "r");
+  if (f == NULL)
+    return -1;
+  while (fgets (line, sizeof (line), f))
+    if (strncmp (line, "VmLck:", 6) == 0)
+      {
+	ret = strtol (line + 6, NULL, 10);
+	break;
+      }
+  fclose (f);
+  return ret;
+}
+
+char *p[N];
+
+int
+main ()
+{
+  omp_allocator_handle_t a;
+  long before, after;
+  int i, j;
+
+  a = omp_init_allocator (omp_default_mem_space, 2, pinned_traits);
+  if (a == omp_null_allocator)
+    abort ();
+
+  before = locked_kb ();
+  for (i = 0; i < N; i++)
+    {
+      p[i] = (char *) omp_alloc (100 + i % 200, a);
+      /* Pinning may fail if RLIMIT_MEMLOCK is too low.  */
+      if (p[i] == NULL)
+	{
+	  while (--i >= 0)
+	    omp_free (p[i], a);
+	  omp_destroy_allocator (a);
+	  return 0;
+	}
+      memset (p[i], i & 0xff, 100 + i % 200);
+    }
+  after = locked_kb ();
+  /* One locked page per allocation would take at least 4000 kB.  */
+  if (before >= 0 && after >= 0 && after - before >= 1000)
+    abort ();
+  for (i = 0; i < N; i++)
+    for (j = 0; j < 100 + i % 200; j++)
+      if (p[i][j] != (char) (i & 0xff))
+	abort ();
+  for (i = 0; i < N; i += 2)
+    omp_free (p[i], a);
+
+  /* Freed blocks are reused, including by calloc and realloc.  */
+  #pragma omp parallel for
+  for (i = 0; i < N; i += 2)
+    {
+      char *q = (char *) omp_calloc (100 + i % 200, 1, a);
+      if (q == NULL)
+	abort ();
+      for (j = 0; j < 100 + i % 200; j++)
+	if (q[j])
+	  abort ();
+      memset (q, 0x5a, 100 + i % 200);
+      q = (char *) omp_realloc (q, 5000, a, a);
+      if (q == NULL)
+	abort ();
+      for (j = 0; j < 100 + i % 200; j++)
+	if (q[j] != 0x5a)
+	  abort ();
+      p[i] = q;
+    }
+  for (i = 1; i < N; i += 2)
+    for (j = 0; j < 100 + i % 200; j++)
+      if (p[i][j] != (char) (i & 0xff))
+	abort ();
+  for (i = 0; i < N; i++)
+    omp_free (p[i], a);
+
+  omp_destroy_allocator (a);
+  return 0;
+}
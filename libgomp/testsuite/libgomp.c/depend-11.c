@@ -0,0 +1,132 @@
+/* Test depend(in:) chains following a depend(out:), including
+   duplicated clauses, and a tiled Cholesky factorization.  */
+
+#include <math.h>
+#include <stdlib.h>
+
+#define NB 6
+#define BS 8
+#define N (NB * BS)
+
+int v[4];
+
+static void
+check_chains (void)
+{
+  int i, j;
+  #pragma omp parallel
+  #pragma omp single
+  for (i = 0; i < 16; i++)
+    {
+      int k = i % 4;
+      #pragma omp task depend(out: v[k]) firstprivate (k, i)
+      v[k] = i;
+      for (j = 0; j < 20; j++)
+	{
+	  #pragma omp task depend(in: v[k]) depend(in: v[k]) firstprivate (k, i)
+	  if (v[k] != i)
+	    abort ();
+	  #pragma omp task depend(in: v[k], v[(k + 1) % 4]) \
+			   depend(in: v[k]) firstprivate (k, i)
+	  if (v[k] != i)
+	    abort ();
+	}
+      #pragma omp task depend(inout: v[k]) depend(in: v[k]) firstprivate (k)
+      v[k]++;
+      #pragma omp task depend(in: v[k]) firstprivate (k, i)
+      if (v[k] != i + 1)
+	abort ();
+    }
+}
+
+double a[NB][NB][BS][BS], orig[N][N];
+
+static void
+potrf (double b[BS][BS])
+{
+  int i, j, k;
+  for (j = 0; j < BS; j++)
+    {
+      for (k = 0; k < j; k++)
+	b[j][j] -= b[j][k] * b[j][k];
+      b[j][j] = sqrt (b[j][j]);
+      for (i = j + 1; i < BS; i++)
+	{
+	  for (k = 0; k < j; k++)
+	    b[i][j] -= b[i][k] * b[j][k];
+	  b[i][j] /= b[j][j];
+	}
+    }
+}
+
+static void
+trsm (double l[BS][BS], double b[BS][BS])
+{
+  int i, j, k;
+  for (i = 0; i < BS; i++)
+    for (j = 0; j < BS; j++)
+      {
+	for (k = 0; k < j; k++)
+	  b[i][j] -= b[i][k] * l[j][k];
+	b[i][j] /= l[j][j];
+      }
+}
+
+static void
+gemm (double x[BS][BS], double y[BS][BS], double b[BS][BS])
+{
+  int i, j, k;
+  for (i = 0; i < BS; i++)
+    for (j = 0; j < BS; j++)
+      for (k = 0; k < BS; k++)
+	b[i][j] -= x[i][k] * y[j][k];
+}
+
+static void
+check_cholesky (void)
+{
+  int i, j, k, ib, jb, kb;
+
+  for (i = 0; i < N; i++)
+    for (j = 0; j < N; j++)
+      orig[i][j] = (i == j ? N : 0) + 1.0 / (1 + i + j);
+  for (i = 0; i < N; i++)
+    for (j = 0; j < N; j++)
+      a[i / BS][j / BS][i % BS][j % BS] = orig[i][j];
+
+  #pragma omp parallel
+  #pragma omp single
+  for (kb = 0; kb < NB; kb++)
+    {
+      #pragma omp task depend(inout: a[kb][kb]) firstprivate (kb)
+      potrf (a[kb][kb]);
+      for (ib = kb + 1; ib < NB; ib++)
+	#pragma omp task depend(in: a[kb][kb]) depend(inout: a[ib][kb]) \
+			 firstprivate (kb, ib)
+	trsm (a[kb][kb], a[ib][kb]);
+      for (ib = kb + 1; ib < NB; ib++)
+	for (jb = kb + 1; jb <= ib; jb++)
+	  #pragma omp task depend(in: a[ib][kb], a[jb][kb]) \
+			   depend(inout: a[ib][jb]) firstprivate (kb, ib, jb)
+	  gemm (a[ib][kb], a[jb][kb], a[ib][jb]);
+    }
+
+  for (i = 0; i < N; i++)
+    for (j = 0; j <= i; j++)
+      {
+	double s = 0;
+	for (k = 0; k <= j; k++)
+	  s += (a[i / BS][k / BS][i % BS][k % BS]
+		* a[j / BS][k / BS][j % BS][k % BS]);
+	if (fabs (s - orig[i][j]) > 1e-9 * N)
+	  abort ();
+      }
+}
+
+int
+main ()
+{
+  check_chains ();
+  check_cholesky ();
+  return 0;
+}
@@ -0,0 +1,85 @@
+/* { dg-do run } */
+/* { dg-set-target-env-var GOMP_HOST_OFFLOAD "1" } */
+
+/* Target regions on the simulated device of the host offload plugin
+   see their own copies of the mapped data.  */
+
+#include <omp.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define N 1024
+
+int a[N], b[N];
+
+int
+main ()
+{
+  int i, dev, sep = 0, x = 0, r = -1;
+  uintptr_t h = (uintptr_t) a;
+  int *p;
+
+  if (omp_get_num_devices () < 1)
+    abort ();
+  /* The host offload devices come after any accelerators.  */
+  dev = omp_get_num_devices () - 1;
+
+  for (i = 0; i < N; i++)
+    a[i] = i;
+  #pragma omp target map(tofrom: a, sep) firstprivate(h) device(dev)
+  {
+    int j;
+    sep = (uintptr_t) a != h;
+    #pragma omp parallel for
+    for (j = 0; j < N; j++)
+      a[j] *= 2;
+  }
+  if (!sep)
+    abort ();
+  for (i = 0; i < N; i++)
+    if (a[i] != 2 * i)
+      abort ();
+
+  /* Changes on the host are not visible on the device without an
+     update.  */
+  b[0] = 1;
+  #pragma omp target enter data map(to: b) device(dev)
+  b[0] = 2;
+  #pragma omp target map(from: r) device(dev)
+  r = b[0];
+  if (r != 1 || b[0] != 2)
+    abort ();
+  #pragma omp target update to(b) device(dev)
+  #pragma omp target map(from: r) device(dev)
+  r = b[0];
+  #pragma omp target exit data map(delete: b) device(dev)
+  if (r != 2)
+    abort ();
+
+  /* Asynchronous target regions ordered by their dependences.  */
+  #pragma omp target nowait map(tofrom: x) depend(out: x) device(dev)
+  x = 1;
+  #pragma omp target nowait map(tofrom: x) depend(inout: x) device(dev)
+  x = x * 10 + 2;
+  #pragma omp taskwait
+  if (x != 12)
+    abort ();
+
+  p = (int *) omp_target_alloc (N * sizeof (int), dev);
+  if (p == NULL || omp_target_is_present (a, dev))
+    abort ();
+  if (omp_target_memcpy (p, a, N * sizeof (int), 0, 0, dev,
+			 omp_get_initial_device ()))
+    abort ();
+  #pragma omp target is_device_ptr(p) device(dev)
+  for (i = 0; i < N; i++)
+    p[i]++;
+  if (omp_target_memcpy (b, p, N * sizeof (int), 0, 0,
+			 omp_get_initial_device (), dev))
+    abort ();
+  omp_target_free (p, dev);
+  for (i = 0; i < N; i++)
+    if (b[i] != 2 * i + 1)
+      abort ();
+  return 0;
+}
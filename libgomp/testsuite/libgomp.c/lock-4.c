@@ -0,0 +1,57 @@
+/* Test locks initialized with hints.  */
+
+#include <omp.h>
+#include <stdlib.h>
+
+static void
+check_lock (omp_sync_hint_t hint)
+{
+  omp_lock_t lock;
+  omp_nest_lock_t nest_lock;
+  int count = 0, nest_count = 0, i;
+
+  omp_init_lock_with_hint (&lock, hint);
+  omp_init_nest_lock_with_hint (&nest_lock, hint);
+  if (!omp_test_lock (&lock))
+    abort ();
+  #pragma omp parallel num_threads (4)
+  {
+    if (omp_get_num_threads () > 1 && omp_test_lock (&lock))
+      abort ();
+    #pragma omp barrier
+    #pragma omp master
+    omp_unset_lock (&lock);
+    #pragma omp for schedule (dynamic, 1)
+    for (i = 0; i < 4000; i++)
+      {
+	omp_set_lock (&lock);
+	count++;
+	omp_unset_lock (&lock);
+	omp_set_nest_lock (&nest_lock);
+	if (omp_test_nest_lock (&nest_lock) != 2)
+	  abort ();
+	nest_count++;
+	omp_unset_nest_lock (&nest_lock);
+	omp_unset_nest_lock (&nest_lock);
+	while (!omp_test_lock (&lock))
+	  ;
+	count++;
+	omp_unset_lock (&lock);
+      }
+  }
+  if (count != 2 * 4000 || nest_count != 4000)
+    abort ();
+  omp_destroy_lock (&lock);
+  omp_destroy_nest_lock (&nest_lock);
+}
+
+int
+main ()
+{
+  check_lock (omp_sync_hint_none);
+  check_lock (omp_sync_hint_uncontended);
+  check_lock (omp_sync_hint_contended);
+  check_lock (omp_sync_hint_contended | omp_sync_hint_speculative);
+  check_lock (omp_sync_hint_uncontended | omp_sync_hint_speculative);
+  return 0;
+}
@@ -0,0 +1,47 @@
+/* Test that threads of nested teams are correctly set up when they
+   are reused by later nested teams.  */
+
+#include <omp.h>
+#include <stdlib.h>
+
+int
+main ()
+{
+  int r;
+
+  omp_set_max_active_levels (2);
+  for (r = 0; r < 50; r++)
+    {
+      #pragma omp parallel num_threads (2)
+      {
+	int outer = omp_get_thread_num ();
+	int n = 2 + (r + outer) % 3, last = -1, cnt = 0, i;
+	#pragma omp parallel num_threads (n) reduction (+: cnt)
+	{
+	  if (omp_get_level () != 2
+	      || omp_get_ancestor_thread_num (1) != outer
+	      || omp_get_team_size (2) != omp_get_num_threads ()
+	      || omp_get_thread_num () >= omp_get_num_threads ())
+	    abort ();
+	  cnt++;
+	}
+	if (cnt > n)
+	  abort ();
+	#pragma omp parallel for ordered num_threads (n) schedule (static, 1)
+	for (i = 0; i < 20; i++)
+	  {
+	    #pragma omp ordered
+	    {
+	      if (last != i - 1)
+		abort ();
+	      last = i;
+	    }
+	  }
+	if (last != 19)
+	  abort ();
+      }
+      if (r == 25 && omp_pause_resource_all (omp_pause_soft) != 0)
+	abort ();
+    }
+  return 0;
+}
@@ -0,0 +1,55 @@
+/* { dg-do run } */
+
+/* Test that schedule(auto) loops, whose schedule is chosen adaptively
+   from previous invocations, still run every iteration exactly once.  */
+
+#include <omp.h>
+#include <stdlib.h>
+
+#define N 1000
+int cnt[N];
+
+static void
+work (int i)
+{
+  /* Make the later iterations much more expensive.  */
+  volatile int j, k = 0;
+  for (j = 0; j < (i > N / 2 ? i : 0); j++)
+    k += j;
+  __atomic_add_fetch (&cnt[i], 1, __ATOMIC_RELAXED);
+}
+
+static void
+check (int expected)
+{
+  int i;
+  for (i = 0; i < N; i++)
+    if (cnt[i] != expected)
+      abort ();
+}
+
+int
+main ()
+{
+  int i, r;
+  unsigned long long u;
+
+  omp_set_schedule (omp_sched_auto, 0);
+  for (r = 1; r <= 20; r++)
+    {
+      #pragma omp parallel num_threads (4)
+      {
+	#pragma omp for schedule(runtime)
+	for (i = 0; i < N; i++)
+	  work (i);
+	#pragma omp for schedule(runtime) nowait
+	for (u = 0; u < N; u++)
+	  work (u);
+      }
+      #pragma omp parallel for schedule(runtime) num_threads (3)
+      for (i = N - 1; i >= 0; i--)
+	work (i);
+      check (3 * r);
+    }
+  return 0;
+}
@@ -0,0 +1,45 @@
+/* { dg-do run { target *-*-linux* } } */
+/* { dg-set-target-env-var GOMP_WAIT_STATS "true" } */
+
+/* Test that GOMP_WAIT_STATS reports barrier and taskwait waits.  */
+
+#include <omp.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+int
+main ()
+{
+  int x = 0, n = 0, started = 0;
+  #pragma omp parallel num_threads (4)
+  {
+    int i;
+    for (i = 0; i < 16; i++)
+      {
+	#pragma omp barrier
+	#pragma omp critical
+	x++;
+      }
+    #pragma omp single
+    {
+      n = omp_get_num_threads ();
+      #pragma omp task shared (started)
+      {
+	__atomic_store_n (&started, 1, __ATOMIC_RELEASE);
+	usleep (100000);
+	x++;
+      }
+      /* Let another thread run the task, so that the taskwait below
+	 has to wait for it.  */
+      if (n > 1)
+	while (!__atomic_load_n (&started, __ATOMIC_ACQUIRE))
+	  ;
+      #pragma omp taskwait
+    }
+  }
+  if (x != n * 16 + 1)
+    abort ();
+  return 0;
+}
+
+/* { dg-output "libgomp: wait statistics.*barrier: \[0-9\]+ waits.*taskwait: \[0-9\]+ waits" } */
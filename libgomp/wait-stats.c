@@ -0,0 +1,94 @@
+/* Copyright (C) 2022 Free Software Foundation, Inc.
+
+   This file is part of the GNU Offloading and Multi Processing Library
+   (libgomp).
+
+   Libgomp is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   Libgomp is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+   FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   Under Section 7 of GPL version 3, you are granted additional
+   permissions described in the GCC Runtime Library Exception, version
+   3.1, as published by the Free Software Foundation.
+
+   You should have received a copy of the GNU General Public License and
+   a copy of the GCC Runtime Library Exception along with this program;
+   see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
+   <http://www.gnu.org/licenses/>.  */
+
+/* This file collects the time threads spend waiting in barriers, for
+   tasks and for mutexes when GOMP_WAIT_STATS is set, and prints a
+   histogram of it per kind of wait when the program exits.  */
+
+#include "libgomp.h"
+#include <stdio.h>
+
+ialias_redirect (omp_get_wtime)
+
+/* Histogram buckets are powers of two of nanoseconds.  */
+#define GOMP_WAIT_STATS_BUCKETS 48
+
+static const char *const gomp_wait_kind_names[GOMP_WAIT_KINDS]
+  = { "barrier", "taskwait", "taskgroup", "mutex" };
+
+static struct
+{
+  unsigned long long count;
+  unsigned long long total_ns;
+  unsigned long long buckets[GOMP_WAIT_STATS_BUCKETS];
+} gomp_wait_stats[GOMP_WAIT_KINDS];
+
+unsigned long long
+gomp_wait_stats_now (void)
+{
+  /* Never return 0, which tells gomp_wait_stats_end that statistics
+     were disabled when the wait started.  */
+  return (unsigned long long) (omp_get_wtime () * 1e9) | 1;
+}
+
+/* Record a wait of kind KIND which started at time START.  */
+
+void
+gomp_wait_stats_record (enum gomp_wait_kind kind, unsigned long long start)
+{
+  unsigned long long ns = gomp_wait_stats_now () - start;
+  int bucket = ns ? 63 - __builtin_clzll (ns) : 0;
+
+  if (bucket >= GOMP_WAIT_STATS_BUCKETS)
+    bucket = GOMP_WAIT_STATS_BUCKETS - 1;
+  __atomic_add_fetch (&gomp_wait_stats[kind].count, 1, MEMMODEL_RELAXED);
+  __atomic_add_fetch (&gomp_wait_stats[kind].total_ns, ns, MEMMODEL_RELAXED);
+  __atomic_add_fetch (&gomp_wait_stats[kind].buckets[bucket], 1,
+		      MEMMODEL_RELAXED);
+}
+
+#ifndef LIBGOMP_OFFLOADED_ONLY
+static void __attribute__((destructor))
+gomp_wait_stats_dump (void)
+{
+  int kind, i;
+
+  if (!gomp_wait_stats_var)
+    return;
+
+  fputs ("libgomp: wait statistics\n", stderr);
+  for (kind = 0; kind < GOMP_WAIT_KINDS; kind++)
+    {
+      if (gomp_wait_stats[kind].count == 0)
+	continue;
+      fprintf (stderr, "  %s: %llu waits, %.6f s total\n",
+	       gomp_wait_kind_names[kind], gomp_wait_stats[kind].count,
+	       gomp_wait_stats[kind].total_ns * 1e-9);
+      for (i = 0; i < GOMP_WAIT_STATS_BUCKETS; i++)
+	if (gomp_wait_stats[kind].buckets[i])
+	  fprintf (stderr, "    < %-12llu ns: %llu\n", 2ULL << i,
+		   gomp_wait_stats[kind].buckets[i]);
+    }
+}
+#endif
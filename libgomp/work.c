@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+ialias_redirect (omp_get_wtime)
 
 /* Allocate a new work share structure, preferably from current team's
    free gomp_work_share cache.  */
@@ -132,6 +133,7 @@ gomp_init_work_share (struct gomp_work_share *ws, size_t ordered,
     ws->ordered_team_ids = ws->inline_ordered_team_ids;
   gomp_ptrlock_init (&ws->next_ws, NULL);
   ws->threads_completed = 0;
+  ws->auto_site = NULL;
 }
 
 /* Do any needed destruction of gomp_work_share fields before it
@@ -220,6 +222,126 @@ gomp_work_share_start (size_t ordered)
     }
 }
 
+/* schedule(auto) loops choose between schedule(static) and
+   schedule(guided) for each call site, based on how well balanced the
+   previous invocations were.  The choice is remembered in a small direct
+   mapped table keyed by the address of the call into the library.
+   Concurrent updates of an entry from different teams can only affect
+   which schedule is chosen.  */
+
+struct gomp_auto_sched_site
+{
+  void *key;
+  /* Schedule used for this site, GFS_STATIC or GFS_GUIDED.  */
+  unsigned sched;
+  /* Number of invocations since the schedule was last changed.  */
+  unsigned count;
+  /* Duration in nanoseconds of the last schedule(static) invocation.  */
+  unsigned long long static_ns;
+};
+
+#define GOMP_AUTO_SCHED_SITES 64
+
+/* A schedule(static) invocation whose slowest thread took more than this
+   many 1/64ths longer than the average switches the site to guided.  */
+#define GOMP_AUTO_SCHED_IMBALANCE 8
+
+/* Number of guided invocations after which static is tried again, in case
+   the loop has become balanced.  */
+#define GOMP_AUTO_SCHED_RETRY 64
+
+static struct gomp_auto_sched_site gomp_auto_sched_sites[GOMP_AUTO_SCHED_SITES];
+
+static inline unsigned long long
+gomp_auto_sched_now (void)
+{
+  return (unsigned long long) (omp_get_wtime () * 1e9);
+}
+
+/* Choose the schedule for a schedule(auto) loop of NTHREADS threads
+   starting at call site KEY, whose work share WS is being initialized.
+   Returns GFS_STATIC or GFS_GUIDED.  */
+
+enum gomp_schedule_type
+gomp_auto_sched_start (struct gomp_work_share *ws, void *key,
+		       unsigned nthreads)
+{
+  struct gomp_auto_sched_site *site;
+  unsigned sched = GFS_STATIC;
+
+  if (nthreads == 1)
+    return GFS_STATIC;
+
+  site = &gomp_auto_sched_sites[((uintptr_t) key >> 4)
+				% GOMP_AUTO_SCHED_SITES];
+  if (__atomic_load_n (&site->key, MEMMODEL_RELAXED) == key)
+    sched = __atomic_load_n (&site->sched, MEMMODEL_RELAXED);
+  else
+    {
+      __atomic_store_n (&site->sched, GFS_STATIC, MEMMODEL_RELAXED);
+      __atomic_store_n (&site->count, 0, MEMMODEL_RELAXED);
+      __atomic_store_n (&site->static_ns, 0, MEMMODEL_RELAXED);
+      __atomic_store_n (&site->key, key, MEMMODEL_RELAXED);
+    }
+  if (sched != GFS_GUIDED)
+    sched = GFS_STATIC;
+
+  ws->auto_site = site;
+  ws->auto_start_ns = gomp_auto_sched_now ();
+  ws->auto_max_ns = 0;
+  ws->auto_sum_ns = 0;
+  ws->auto_done = 0;
+  return sched;
+}
+
+/* The current thread has finished its share of the schedule(auto) loop
+   WS run by NTHREADS threads.  The last one to do so updates the choice
+   of schedule for the call site.  */
+
+void
+gomp_auto_sched_end (struct gomp_work_share *ws, unsigned nthreads)
+{
+  struct gomp_auto_sched_site *site = ws->auto_site;
+  unsigned long long ns = gomp_auto_sched_now () - ws->auto_start_ns;
+  unsigned long long max_ns, sum_ns, avg_ns;
+  unsigned count;
+
+  max_ns = __atomic_load_n (&ws->auto_max_ns, MEMMODEL_RELAXED);
+  while (ns > max_ns
+	 && !__atomic_compare_exchange_n (&ws->auto_max_ns, &max_ns, ns,
+					  true, MEMMODEL_RELAXED,
+					  MEMMODEL_RELAXED))
+    ;
+  __atomic_add_fetch (&ws->auto_sum_ns, ns, MEMMODEL_RELAXED);
+  if (__atomic_add_fetch (&ws->auto_done, 1, MEMMODEL_ACQ_REL) != nthreads)
+    return;
+
+  max_ns = __atomic_load_n (&ws->auto_max_ns, MEMMODEL_RELAXED);
+  sum_ns = __atomic_load_n (&ws->auto_sum_ns, MEMMODEL_RELAXED);
+  avg_ns = sum_ns / nthreads;
+  count = __atomic_load_n (&site->count, MEMMODEL_RELAXED) + 1;
+  if (ws->sched == GFS_STATIC)
+    {
+      __atomic_store_n (&site->static_ns, max_ns, MEMMODEL_RELAXED);
+      if ((max_ns - avg_ns) * 64 > max_ns * GOMP_AUTO_SCHED_IMBALANCE)
+	{
+	  __atomic_store_n (&site->sched, GFS_GUIDED, MEMMODEL_RELAXED);
+	  count = 0;
+	}
+    }
+  /* Go back to static if guided was clearly slower than the last static
+     invocation, or periodically to find out whether it still is.  */
+  else if (count >= GOMP_AUTO_SCHED_RETRY
+	   || (max_ns * 64
+	       > (__atomic_load_n (&site->static_ns, MEMMODEL_RELAXED)
+		  * (64 + GOMP_AUTO_SCHED_IMBALANCE))))
+    {
+      __atomic_store_n (&site->sched, GFS_STATIC, MEMMODEL_RELAXED);
+      count = 0;
+    }
+  __atomic_store_n (&site->count, count, MEMMODEL_RELAXED);
+}
+
 /* The current thread is done with its current work sharing construct.
    This version does imply a barrier at the end of the work-share.  */
 
@@ -238,6 +360,9 @@ gomp_work_share_end (void)
       return;
     }
 
+  if (__builtin_expect (thr->ts.work_share->auto_site != NULL, 0))
+    gomp_auto_sched_end (thr->ts.work_share, team->nthreads);
+
   bstate = gomp_barrier_wait_start (&team->barrier);
 
   if (gomp_barrier_last_thread (bstate))
@@ -264,6 +389,8 @@ gomp_work_share_end_cancel (void)
   gomp_barrier_state_t bstate;
 
   /* Cancellable work sharing constructs cannot be orphaned.  */
+  if (__builtin_expect (thr->ts.work_share->auto_site != NULL, 0))
+    gomp_auto_sched_end (thr->ts.work_share, team->nthreads);
   bstate = gomp_barrier_wait_cancel_start (&team->barrier);
 
   if (gomp_barrier_last_thread (bstate))
@@ -298,6 +425,9 @@ gomp_work_share_end_nowait (void)
       return;
     }
 
+  if (__builtin_expect (ws->auto_site != NULL, 0))
+    gomp_auto_sched_end (ws, team->nthreads);
+
   if (__builtin_expect (thr->ts.last_work_share == NULL, 0))
     return;
 